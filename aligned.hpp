@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
+namespace fixp {
+    // Cache line alignment, which is also a multiple of every vector
+    // width we have kernels for
+    static constexpr std::size_t DefaultAlignment = 64;
+
+    // n rounded up to a whole number of Alignment sized blocks of T,
+    // so that kernels can run over the padding instead of a tail loop
+    template<typename T, const std::size_t Alignment = DefaultAlignment>
+    static constexpr std::size_t padded_size(std::size_t n) {
+        constexpr std::size_t Block = Alignment >= sizeof(T) ? Alignment / sizeof(T) : 1;
+        return (n + Block - 1) / Block * Block;
+    }
+
+    // Allocates with at least Alignment bytes of alignment
+    template<typename T, const std::size_t Alignment = DefaultAlignment>
+    requires (Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0)
+    struct aligned_allocator {
+        using value_type = T;
+
+        template<typename U>
+        struct rebind { using other = aligned_allocator<U, Alignment>; };
+
+        constexpr aligned_allocator() noexcept = default;
+
+        template<typename U>
+        constexpr aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+        [[nodiscard]] T* allocate(std::size_t n) {
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t { Alignment }));
+        }
+
+        void deallocate(T* p, std::size_t) noexcept {
+            ::operator delete(p, std::align_val_t { Alignment });
+        }
+
+        template<typename U>
+        constexpr bool operator==(const aligned_allocator<U, Alignment>&) const noexcept { return true; }
+    };
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <span>
+#include <vector>
+#include <aligned.hpp>
+#include <bulk.hpp>
+#include <fixp.hpp>
+
+namespace fixp {
+    // An owning array of fixed values whose storage is aligned to
+    // Alignment bytes and padded to a whole number of Alignment sized
+    // blocks. The kernel overloads below run over the padded length
+    // with aligned pointers, so the vector loops cover every element
+    // with no scalar tail and no peeling for alignment.
+    //
+    // The padding holds valid but unspecified values once a kernel has
+    // written to the array.
+    template<is_fixed T, const std::size_t Alignment = DefaultAlignment>
+    class array {
+        private:
+            std::vector<T, aligned_allocator<T, Alignment>> storage;
+            std::size_t count = 0;
+
+        public:
+            using value_type = T;
+            using iterator = T*;
+            using const_iterator = const T*;
+            static constexpr std::size_t Align = Alignment;
+
+            array() = default;
+
+            // n zeros
+            explicit array(std::size_t n) { resize(n); }
+
+            array(const T* values, std::size_t n) {
+                resize(n);
+                std::copy(values, values + n, storage.begin());
+            }
+
+            array(std::initializer_list<T> values) : array(values.begin(), values.size()) {}
+
+            std::size_t size() const { return count; }
+            bool empty() const { return count == 0; }
+
+            // Number of elements the kernels process, a multiple of
+            // Alignment / sizeof(T)
+            std::size_t padded_size() const { return storage.size(); }
+
+            // New elements and the padding are zero
+            void resize(std::size_t n) {
+                storage.resize(fixp::padded_size<T, Alignment>(n));
+                std::fill(storage.begin() + static_cast<std::ptrdiff_t>(std::min(n, count)), storage.end(), T::from_raw(0));
+                count = n;
+            }
+
+            T* data() { return std::assume_aligned<Alignment>(storage.data()); }
+            const T* data() const { return std::assume_aligned<Alignment>(storage.data()); }
+
+            T& operator[](std::size_t i) { return storage[i]; }
+            const T& operator[](std::size_t i) const { return storage[i]; }
+
+            iterator begin() { return data(); }
+            iterator end() { return data() + count; }
+            const_iterator begin() const { return data(); }
+            const_iterator end() const { return data() + count; }
+
+            operator std::span<T>() { return { data(), count }; }
+            operator std::span<const T>() const { return { data(), count }; }
+    };
+
+    namespace detail::bulk {
+        // out is resized to match in, every other input must already
+        // have the same size
+        template<is_fixed T, std::size_t A, is_fixed U, std::size_t B>
+        static inline std::size_t
+        match(const array<T, A>& in, array<U, B>& out) {
+            if (out.size() != in.size()) {
+                out.resize(in.size());
+            }
+
+            return in.padded_size();
+        }
+    }
+
+    // The other array operands must have the size of a (checked with
+    // assert), since the kernels run over its padded length; out is
+    // resized to match.
+
+    template<is_fixed T, std::size_t A>
+    static inline void
+    add_saturate(const array<T, A>& a, const array<T, A>& b, array<T, A>& out) {
+        assert(b.size() == a.size());
+
+        const std::size_t n = detail::bulk::match(a, out);
+        detail::bulk::saturating_add<false, (A >= 32)>(a.data(), b.data(), out.data(), n);
+    }
+
+    template<is_fixed T, std::size_t A>
+    static inline void
+    sub_saturate(const array<T, A>& a, const array<T, A>& b, array<T, A>& out) {
+        assert(b.size() == a.size());
+
+        const std::size_t n = detail::bulk::match(a, out);
+        detail::bulk::saturating_add<true, (A >= 32)>(a.data(), b.data(), out.data(), n);
+    }
+
+    template<rounding Rounding = rounding::nearest, is_fixed T, std::size_t A>
+    static inline void
+    fma(const array<T, A>& a, const array<T, A>& b, const array<T, A>& c, array<T, A>& out) {
+        assert(b.size() == a.size());
+        assert(c.size() == a.size());
+
+        const std::size_t n = detail::bulk::match(a, out);
+        detail::bulk::fma<Rounding, false>(a.data(), b.data(), c.data(), out.data(), n);
+    }
+
+    template<rounding Rounding = rounding::nearest, is_fixed T, std::size_t A>
+    static inline void
+    fma(const array<T, A>& a, const T& b, const array<T, A>& c, array<T, A>& out) {
+        assert(c.size() == a.size());
+
+        const std::size_t n = detail::bulk::match(a, out);
+        detail::bulk::fma<Rounding, true>(a.data(), &b, c.data(), out.data(), n);
+    }
+
+    template<typename Poly, poly_scheme Scheme = poly_scheme::horner, rounding Rounding = rounding::nearest, is_fixed T, std::size_t A>
+    static inline void
+    evaluate(const array<T, A>& in, array<T, A>& out) {
+        const std::size_t n = detail::bulk::match(in, out);
+        detail::bulk::evaluate<Poly, Scheme, Rounding>(in.data(), out.data(), n);
+    }
+
+    // Only the first in.size() elements are converted, the padding of
+    // two formats of different widths does not line up
+    template<overflow Overflow = overflow::saturate, is_fixed From, std::size_t A, is_fixed To, std::size_t B>
+    static inline void
+    convert(const array<From, A>& in, array<To, B>& out) {
+        if (out.size() != in.size()) {
+            out.resize(in.size());
+        }
+
+        convert<Overflow>(in.data(), out.data(), in.size());
+    }
+}
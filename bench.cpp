@@ -4,10 +4,26 @@
 #include <iostream>
 #include <format>
 #include <cmath>
+#include <complex>
 #include <functional>
 
 #include <fixp.hpp>
 #include <simd_neon.hpp>
+#include <fir.hpp>
+#include <biquad.hpp>
+#include <fft.hpp>
+#include <nco.hpp>
+#include <bulk.hpp>
+#include <divider.hpp>
+#include <expr.hpp>
+#include <soa.hpp>
+#include <array.hpp>
+#include <dataset.hpp>
+#include <bitpacked.hpp>
+#include <codec.hpp>
+#include <pipeline.hpp>
+#include <parallel.hpp>
+#include <pool.hpp>
 
 #define ANKERL_NANOBENCH_IMPLEMENT
 #include <nanobench.h>
@@ -149,6 +165,731 @@ namespace benches {
         }
     }
 
+    namespace dsp {
+        template<fixp::is_fixed T, const std::size_t N>
+        std::vector<T> random_signal() {
+            std::vector<T> signal(N);
+
+            for (auto& x : signal) {
+                x = 2.0f * (rng.uniform01() - 0.5f);
+            }
+
+            return signal;
+        }
+
+        template<fixp::is_fixed T, const std::size_t Taps, const std::size_t BlockSize>
+        void fir_block() {
+            static auto filter = []() {
+                std::array<T, Taps> coeffs;
+
+                for (auto& c : coeffs) {
+                    c = rng.uniform01() / static_cast<float>(Taps);
+                }
+
+                return fixp::dsp::fir<T, Taps>(coeffs);
+            }();
+
+            static const std::vector<T> in = random_signal<T, BlockSize>();
+            static std::vector<T> out(BlockSize);
+
+            filter.process(in.data(), out.data(), BlockSize);
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T, const std::size_t Channels, const std::size_t Frames>
+        void biquad_block() {
+            using coeff = fixp::fixed<T::FracBits - 1, typename T::storage_type, typename T::intermediate_type>;
+            using cascade = fixp::dsp::biquad_cascade<T, 4, Channels, fixp::dsp::biquad_form::df1_error_feedback, coeff>;
+
+            static cascade filter({{
+                { 0.0675f, 0.1349f, 0.0675f, -1.1430f, 0.4128f },
+                { 0.0675f, 0.1349f, 0.0675f, -1.1430f, 0.4128f },
+                { 0.0675f, 0.1349f, 0.0675f, -1.1430f, 0.4128f },
+                { 0.0675f, 0.1349f, 0.0675f, -1.1430f, 0.4128f },
+            }});
+
+            static const std::vector<T> in = random_signal<T, Frames * Channels>();
+            static std::vector<T> out(Frames * Channels);
+
+            filter.process(in.data(), out.data(), Frames);
+            nanobench::doNotOptimizeAway(out);
+        }
+    }
+
+    namespace convert {
+        static const std::vector<float>& random_floats() {
+            static const std::vector<float> values = []() {
+                std::vector<float> v(8192);
+
+                for (auto& x : v) {
+                    x = 2.0f * (rng.uniform01() - 0.5f);
+                }
+
+                return v;
+            }();
+
+            return values;
+        }
+
+        template<fixp::is_fixed T>
+        void from_float_bulk() {
+            static std::vector<T> out(random_floats().size());
+
+            fixp::from_float(random_floats().data(), out.data(), out.size());
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T>
+        void from_float_classical() {
+            static std::vector<T> out(random_floats().size());
+
+            for (std::size_t i = 0; i < out.size(); i++) {
+                out[i] = T(random_floats()[i]);
+            }
+
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T>
+        void to_float_bulk() {
+            static const std::vector<T> in = dsp::random_signal<T, 8192>();
+            static std::vector<float> out(in.size());
+
+            fixp::to_float(in.data(), out.data(), in.size());
+            nanobench::doNotOptimizeAway(out);
+        }
+    }
+
+    namespace divide {
+        template<fixp::is_fixed T>
+        void divider_bulk() {
+            static const std::vector<T> in = dsp::random_signal<T, 8192>();
+            static std::vector<T> out(in.size());
+
+            const fixp::divider<T> divider(T(rng.uniform01() + 1.0f));
+
+            divider.divide(in.data(), out.data(), in.size());
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T>
+        static const std::vector<T>& random_divisors() {
+            static const std::vector<T> divisors = []() {
+                std::vector<T> v(8192);
+
+                for (auto& x : v) {
+                    x = rng.uniform01() + 0.5f;
+                }
+
+                return v;
+            }();
+
+            return divisors;
+        }
+
+        template<fixp::is_fixed T, const fixp::division_accuracy Accuracy>
+        void newton_div_bulk() {
+            static const std::vector<T> in = dsp::random_signal<T, 8192>();
+            static std::vector<T> out(in.size());
+
+            fixp::div<Accuracy>(in.data(), random_divisors<T>().data(), out.data(), in.size());
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T>
+        void elementwise_div() {
+            static const std::vector<T> in = dsp::random_signal<T, 8192>();
+            static std::vector<T> out(in.size());
+
+            const auto& divisors = random_divisors<T>();
+
+            for (std::size_t i = 0; i < in.size(); i++) {
+                out[i] = in[i] / divisors[i];
+            }
+
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T>
+        void operator_div() {
+            static const std::vector<T> in = dsp::random_signal<T, 8192>();
+            static std::vector<T> out(in.size());
+
+            const T d = rng.uniform01() + 1.0f;
+
+            for (std::size_t i = 0; i < in.size(); i++) {
+                out[i] = in[i] / d;
+            }
+
+            nanobench::doNotOptimizeAway(out);
+        }
+    }
+
+    namespace fma {
+        template<fixp::is_fixed T>
+        void fma_bulk() {
+            static const std::vector<T> a = dsp::random_signal<T, 8192>();
+            static const std::vector<T> b = dsp::random_signal<T, 8192>();
+            static const std::vector<T> c = dsp::random_signal<T, 8192>();
+            static std::vector<T> out(a.size());
+
+            fixp::fma(a.data(), b.data(), c.data(), out.data(), out.size());
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T>
+        void mul_add() {
+            static const std::vector<T> a = dsp::random_signal<T, 8192>();
+            static const std::vector<T> b = dsp::random_signal<T, 8192>();
+            static const std::vector<T> c = dsp::random_signal<T, 8192>();
+            static std::vector<T> out(a.size());
+
+            for (std::size_t i = 0; i < out.size(); i++) {
+                out[i] = a[i] * b[i] + c[i];
+            }
+
+            nanobench::doNotOptimizeAway(out);
+        }
+    }
+
+    namespace poly {
+        using cubic = fixp::poly<0.5, -1.25, 0.375, 0.0625>;
+
+        template<fixp::is_fixed T, fixp::poly_scheme Scheme>
+        void evaluate_bulk() {
+            static const std::vector<T> in = dsp::random_signal<T, 8192>();
+            static std::vector<T> out(in.size());
+
+            fixp::evaluate<cubic, Scheme>(in.data(), out.data(), out.size());
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T>
+        void operator_horner() {
+            static const std::vector<T> in = dsp::random_signal<T, 8192>();
+            static std::vector<T> out(in.size());
+
+            constexpr T c0 = 0.5f, c1 = -1.25f, c2 = 0.375f, c3 = 0.0625f;
+
+            for (std::size_t i = 0; i < out.size(); i++) {
+                out[i] = c0 + in[i] * (c1 + in[i] * (c2 + in[i] * c3));
+            }
+
+            nanobench::doNotOptimizeAway(out);
+        }
+    }
+
+    namespace expr {
+        template<fixp::is_fixed T>
+        void fused() {
+            static const std::vector<T> a = dsp::random_signal<T, 8192>();
+            static const std::vector<T> x = dsp::random_signal<T, 8192>();
+            static const std::vector<T> b = dsp::random_signal<T, 8192>();
+            static std::vector<T> y(a.size());
+
+            fixp::expr::assign(y.data(), fixp::lazy(a) * fixp::lazy(x) + fixp::lazy(b));
+            nanobench::doNotOptimizeAway(y);
+        }
+
+        // One pass per operator through a temporary
+        template<fixp::is_fixed T>
+        void separate() {
+            static const std::vector<T> a = dsp::random_signal<T, 8192>();
+            static const std::vector<T> x = dsp::random_signal<T, 8192>();
+            static const std::vector<T> b = dsp::random_signal<T, 8192>();
+            static std::vector<T> tmp(a.size()), y(a.size());
+
+            #pragma omp simd
+            for (std::size_t i = 0; i < tmp.size(); i++) {
+                tmp[i] = a[i] * x[i];
+            }
+
+            nanobench::doNotOptimizeAway(tmp);
+
+            #pragma omp simd
+            for (std::size_t i = 0; i < y.size(); i++) {
+                y[i] = tmp[i] + b[i];
+            }
+
+            nanobench::doNotOptimizeAway(y);
+        }
+    }
+
+    namespace soa {
+        template<fixp::is_fixed T>
+        using vec3 = fixp::linalg::vec3<T>;
+
+        template<fixp::is_fixed T>
+        static std::vector<vec3<T>> random_vectors() {
+            const std::vector<T> x = dsp::random_signal<T, 3 * 8192>();
+            std::vector<vec3<T>> v(8192);
+
+            for (std::size_t i = 0; i < v.size(); i++) {
+                v[i] = vec3<T>(x[3 * i], x[3 * i + 1], x[3 * i + 2]);
+            }
+
+            return v;
+        }
+
+        template<fixp::is_fixed T>
+        void integrate_soa() {
+            static fixp::soa<vec3<T>> position, velocity;
+            static const T dt = 0.01f;
+
+            if (position.empty()) {
+                for (const auto& v : random_vectors<T>()) {
+                    position.push_back(v);
+                    velocity.push_back(v);
+                }
+            }
+
+            fixp::fma(velocity, dt, position, position);
+            nanobench::doNotOptimizeAway(position);
+        }
+
+        template<fixp::is_fixed T>
+        void integrate_aos() {
+            static std::vector<vec3<T>> position = random_vectors<T>();
+            static const std::vector<vec3<T>> velocity = random_vectors<T>();
+            static const T dt = 0.01f;
+
+            for (std::size_t i = 0; i < position.size(); i++) {
+                position[i] += velocity[i] * dt;
+            }
+
+            nanobench::doNotOptimizeAway(position);
+        }
+    }
+
+    namespace aligned {
+        // Short arrays, where the tail loop is a large part of the work
+        template<fixp::is_fixed T, std::size_t N>
+        void add_saturate_array() {
+            static const std::vector<T> x = dsp::random_signal<T, N>();
+            static const fixp::array<T> a(x.data(), N), b(x.data(), N);
+            static fixp::array<T> out(N);
+
+            fixp::add_saturate(a, b, out);
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T, std::size_t N>
+        void add_saturate_pointer() {
+            static const std::vector<T> a = dsp::random_signal<T, N + 1>();
+            static std::vector<T> out(N + 1);
+
+            // Misaligned by one element
+            fixp::add_saturate(a.data() + 1, a.data() + 1, out.data() + 1, N);
+            nanobench::doNotOptimizeAway(out);
+        }
+    }
+
+    namespace dataset {
+        // 1M values, written once
+        template<fixp::is_fixed T>
+        static const char* path() {
+            static const char* p = [] {
+                const std::vector<T> values = dsp::random_signal<T, 1 << 20>();
+                fixp::write_dataset<T>("fixp-bench-dataset.fxpd", values);
+                return "fixp-bench-dataset.fxpd";
+            }();
+
+            return p;
+        }
+
+        // Open and read one value from the middle
+        template<fixp::is_fixed T>
+        void open_mapped() {
+            auto dataset = fixp::mapped_dataset<T>::open(path<T>());
+            nanobench::doNotOptimizeAway((*dataset)[dataset->size() / 2]);
+        }
+
+        template<fixp::is_fixed T>
+        void open_read() {
+            std::ifstream file(path<T>(), std::ios::binary);
+            fixp::dataset_header header;
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+            std::vector<T> values(header.count);
+            file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+            nanobench::doNotOptimizeAway(values[values.size() / 2]);
+        }
+    }
+
+    namespace bitpacked {
+        template<fixp::is_fixed T, std::size_t Bits>
+        static const fixp::bitpacked<T, Bits>& packed_signal() {
+            static const fixp::bitpacked<T, Bits> packed = [] {
+                std::vector<T> x = dsp::random_signal<T, 8192>();
+                for (T& v : x) {
+                    v.raw >>= sizeof(typename T::storage_type) * 8 - Bits;
+                }
+
+                return fixp::bitpacked<T, Bits>(x);
+            }();
+
+            return packed;
+        }
+
+        template<fixp::is_fixed T, std::size_t Bits>
+        void unpack() {
+            static std::vector<T> out(8192);
+
+            packed_signal<T, Bits>().unpack(out.data());
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T, std::size_t Bits>
+        void pack() {
+            static const std::vector<T> in = [] {
+                std::vector<T> x(8192);
+                packed_signal<T, Bits>().unpack(x.data());
+                return x;
+            }();
+            static fixp::bitpacked<T, Bits> out(in.size());
+
+            fixp::pack<Bits>(in.data(), out.data(), in.size());
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        // Reading the same values at full width, for comparison
+        template<fixp::is_fixed T>
+        void copy() {
+            static const std::vector<T> in = dsp::random_signal<T, 8192>();
+            static std::vector<T> out(in.size());
+
+            std::copy(in.begin(), in.end(), out.begin());
+            nanobench::doNotOptimizeAway(out);
+        }
+    }
+
+    namespace codec {
+        // Slowly changing, like telemetry
+        template<fixp::is_fixed T>
+        static const std::vector<T>& slow_signal() {
+            static const std::vector<T> x = [] {
+                std::vector<T> x(8192);
+                for (std::size_t i = 0; i < x.size(); i++) {
+                    x[i] = T(0.5f * std::sin(static_cast<float>(i) / 2000.0f));
+                }
+
+                return x;
+            }();
+
+            return x;
+        }
+
+        template<fixp::is_fixed T>
+        void encode() {
+            static std::vector<std::uint32_t> out;
+
+            out.clear();
+            fixp::block_encoder<T> encoder(out);
+            encoder.push(slow_signal<T>());
+            encoder.finish();
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T>
+        void decode() {
+            static const std::vector<std::uint32_t> in = fixp::encode<T>(slow_signal<T>());
+            static std::vector<T> out(8192 + fixp::detail::packing::BlockSize);
+
+            fixp::block_decoder<T> decoder(in);
+            for (std::size_t at = 0; !decoder.done();) {
+                at += decoder.next(out.data() + at).value();
+            }
+            nanobench::doNotOptimizeAway(out);
+        }
+    }
+
+    namespace pipeline {
+        // Much larger than L2
+        static constexpr std::size_t N = 1 << 23;
+
+        template<fixp::is_fixed T>
+        static void shrink(const T* in, T* out, std::size_t n) {
+            fixp::fma(in, T(-0.75f), in, out, n);
+        }
+
+        template<fixp::is_fixed T>
+        static void grow(const T* in, T* out, std::size_t n) {
+            fixp::fma(in, T(0.75f), in, out, n);
+        }
+
+        template<fixp::is_fixed T>
+        static void twice(const T* in, T* out, std::size_t n) {
+            fixp::add_saturate(in, in, out, n);
+        }
+
+        template<fixp::is_fixed T>
+        static std::vector<T>& buffer() {
+            static std::vector<T> x = dsp::random_signal<T, N>();
+            return x;
+        }
+
+        // Each stage over the whole array in turn
+        template<fixp::is_fixed T>
+        void passes() {
+            std::vector<T>& x = buffer<T>();
+
+            shrink(x.data(), x.data(), x.size());
+            grow(x.data(), x.data(), x.size());
+            twice(x.data(), x.data(), x.size());
+            nanobench::doNotOptimizeAway(x);
+        }
+
+        template<fixp::is_fixed T, bool Threaded>
+        void chunked() {
+            static fixp::pipeline<T> p = [] {
+                fixp::pipeline<T> p;
+                p.then(shrink<T>).then(grow<T>).then(twice<T>);
+                return p;
+            }();
+            std::vector<T>& x = buffer<T>();
+
+            if constexpr (Threaded) {
+                p.run_threaded(x.data(), x.data(), x.size());
+            } else {
+                p.run(x.data(), x.data(), x.size());
+            }
+            nanobench::doNotOptimizeAway(x);
+        }
+    }
+
+    namespace parallel {
+        static constexpr std::size_t N = 1 << 20;
+
+        template<fixp::is_fixed T, bool Parallel>
+        void fma() {
+            static const std::vector<T> a = dsp::random_signal<T, N>();
+            static const std::vector<T> b = dsp::random_signal<T, N>();
+            static const std::vector<T> c = dsp::random_signal<T, N>();
+            static std::vector<T> out(N);
+
+            if constexpr (Parallel) {
+                fixp::parallel::fma(a.data(), b.data(), c.data(), out.data(), out.size());
+            } else {
+                fixp::fma(a.data(), b.data(), c.data(), out.data(), out.size());
+            }
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T, bool Parallel>
+        void dot() {
+            static const std::vector<T> a = dsp::random_signal<T, N>();
+            static const std::vector<T> b = dsp::random_signal<T, N>();
+
+            if constexpr (Parallel) {
+                nanobench::doNotOptimizeAway(fixp::parallel::dot<T, std::int64_t>(a.data(), b.data(), a.size()));
+            } else {
+                nanobench::doNotOptimizeAway(fixp::dsp::detail::dot<std::int64_t>(&a[0].raw, &b[0].raw, a.size()));
+            }
+        }
+    }
+
+    namespace pool {
+        // Jobs from 256 to 64k values, all at once
+        static constexpr std::size_t Jobs = 64;
+
+        static std::size_t job_size(std::size_t j) {
+            return std::size_t { 256 } << (j % 9);
+        }
+
+        template<fixp::is_fixed T>
+        static std::vector<std::vector<T>>& job_data() {
+            static std::vector<std::vector<T>> data = [] {
+                std::vector<std::vector<T>> data;
+                for (std::size_t j = 0; j < Jobs; j++) {
+                    data.push_back(dsp::random_signal<T, 65536>());
+                    data.back().resize(job_size(j));
+                }
+                return data;
+            }();
+
+            return data;
+        }
+
+        template<fixp::is_fixed T>
+        void openmp() {
+            auto& data = job_data<T>();
+
+            #pragma omp parallel for schedule(static)
+            for (std::size_t j = 0; j < Jobs; j++) {
+                fixp::evaluate<fixp::poly<0.5, -1.25, 0.375>>(data[j].data(), data[j].data(), data[j].size());
+            }
+            nanobench::doNotOptimizeAway(data);
+        }
+
+        template<fixp::is_fixed T>
+        void stealing() {
+            static fixp::task_pool workers;
+            auto& data = job_data<T>();
+
+            fixp::task_pool::group jobs;
+            for (std::size_t j = 0; j < Jobs; j++) {
+                workers.submit(jobs, [&v = data[j]] {
+                    fixp::evaluate<fixp::poly<0.5, -1.25, 0.375>>(v.data(), v.data(), v.size());
+                });
+            }
+            workers.wait(jobs);
+            nanobench::doNotOptimizeAway(data);
+        }
+    }
+
+    namespace saturate {
+        template<fixp::is_fixed T>
+        static const std::vector<T>& random_raw(std::size_t seed) {
+            static std::vector<T> values[2];
+
+            if (values[seed].empty()) {
+                values[seed].resize(8192);
+
+                for (auto& x : values[seed]) {
+                    x = T::from_raw(static_cast<typename T::storage_type>(rng()));
+                }
+            }
+
+            return values[seed];
+        }
+
+        template<fixp::is_fixed T>
+        void add_saturate_bulk() {
+            static std::vector<T> out(8192);
+
+            fixp::add_saturate(random_raw<T>(0).data(), random_raw<T>(1).data(), out.data(), out.size());
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T>
+        void add_saturate_classical() {
+            using Storage = typename T::storage_type;
+            static std::vector<T> out(8192);
+
+            const auto& a = random_raw<T>(0);
+            const auto& b = random_raw<T>(1);
+
+            for (std::size_t i = 0; i < out.size(); i++) {
+                const auto sum = static_cast<std::int64_t>(a[i].raw) + b[i].raw;
+                out[i] = T::from_raw(static_cast<Storage>(std::clamp<std::int64_t>(sum,
+                                                                                   std::numeric_limits<Storage>::min(),
+                                                                                   std::numeric_limits<Storage>::max())));
+            }
+
+            nanobench::doNotOptimizeAway(out);
+        }
+    }
+
+    namespace nco {
+        template<fixp::is_fixed T, const std::size_t Channels, const std::size_t Frames>
+        void nco_block() {
+            static auto oscillator = []() {
+                fixp::dsp::nco<T, Channels> nco;
+
+                for (std::size_t ch = 0; ch < Channels; ch++) {
+                    nco.set_frequency(ch, 0.5 * rng.uniform01());
+                }
+
+                return nco;
+            }();
+
+            static std::vector<T> out(Channels * Frames);
+
+            oscillator.generate(out.data(), Frames);
+            nanobench::doNotOptimizeAway(out);
+        }
+
+        template<fixp::is_fixed T, const std::size_t Channels, const std::size_t Frames>
+        void sin_block() {
+            static const std::vector<T> increments = dsp::random_signal<T, Channels>();
+            static std::vector<T> phases(Channels, T(0));
+            static std::vector<T> out(Channels * Frames);
+
+            for (std::size_t n = 0; n < Frames; n++) {
+                for (std::size_t ch = 0; ch < Channels; ch++) {
+                    out[n * Channels + ch] = fixp::sin(phases[ch]);
+                    phases[ch] = (phases[ch] + increments[ch]) % T(two_pi);
+                }
+            }
+
+            nanobench::doNotOptimizeAway(out);
+        }
+    }
+
+    namespace fft {
+        // Plain iterative radix-2 reference
+        template<const std::size_t N>
+        void float_fft_radix2(std::complex<float>* data) {
+            for (std::size_t i = 1, j = 0; i < N; i++) {
+                std::size_t bit = N >> 1;
+
+                while (j & bit) {
+                    j ^= bit;
+                    bit >>= 1;
+                }
+
+                j ^= bit;
+
+                if (i < j) {
+                    std::swap(data[i], data[j]);
+                }
+            }
+
+            for (std::size_t h = 1; h < N; h *= 2) {
+                for (std::size_t j = 0; j < h; j++) {
+                    const std::complex<float> w = std::polar(1.0f, -std::numbers::pi_v<float> * j / h);
+
+                    for (std::size_t k = 0; k < N; k += 2 * h) {
+                        const std::complex<float> t = w * data[k + j + h];
+
+                        data[k + j + h] = data[k + j] - t;
+                        data[k + j] += t;
+                    }
+                }
+            }
+        }
+
+        template<const std::size_t N>
+        void float_fft() {
+            static const std::vector<std::complex<float>> in = []() {
+                std::vector<std::complex<float>> signal(N);
+
+                for (auto& x : signal) {
+                    x = { static_cast<float>(rng.uniform01() - 0.5), static_cast<float>(rng.uniform01() - 0.5) };
+                }
+
+                return signal;
+            }();
+
+            static std::vector<std::complex<float>> data(N);
+
+            std::copy(in.begin(), in.end(), data.begin());
+            float_fft_radix2<N>(data.data());
+            nanobench::doNotOptimizeAway(data);
+        }
+
+        template<fixp::is_fixed T, const std::size_t N>
+        void fixed_fft() {
+            static const std::vector<T> in = dsp::random_signal<T, 2 * N>();
+            static std::vector<T> data(2 * N);
+
+            std::copy(in.begin(), in.end(), data.begin());
+            int exponent = fixp::dsp::fft<T, N>::forward(data.data());
+            nanobench::doNotOptimizeAway(exponent);
+            nanobench::doNotOptimizeAway(data);
+        }
+
+        template<fixp::is_fixed T, const std::size_t N>
+        void fixed_rfft() {
+            static const std::vector<T> in = dsp::random_signal<T, N>();
+            static std::vector<T> data(N + 2);
+
+            int exponent = fixp::dsp::rfft<T, N>::forward(in.data(), data.data());
+            nanobench::doNotOptimizeAway(exponent);
+            nanobench::doNotOptimizeAway(data);
+        }
+    }
+
     namespace simd {
         template<std::signed_integral T>
         void mul_simd(const T* a, const T* b, T* result, std::size_t dim)
@@ -219,6 +960,10 @@ using fixed_q16_16 = fixp::fixed<16, std::int32_t, std::int64_t>;
 using fixed_q24_8 = fixp::fixed<24, std::int32_t, std::int64_t>;
 using fixed_q4_12 = fixp::fixed<12, std::int16_t, std::int32_t>;
 using fixed_q8_8 = fixp::fixed<8, std::int16_t, std::int32_t>;
+using fixed_q0_15 = fixp::fixed<15, std::int16_t, std::int32_t>;
+using fixed_q32_32 = fixp::fixed<32, std::int64_t, __int128>;
+using fixed_uq0_8 = fixp::fixed<8, std::uint8_t, std::uint16_t>;
+using fixed_uq0_16 = fixp::fixed<16, std::uint16_t, std::uint32_t>;
 
 int main(int argc, char *argv[])
 {
@@ -244,18 +989,22 @@ int main(int argc, char *argv[])
         { "fixed add Q16.16",  benches::arithmetic::fixed_add<fixed_q16_16>   },
         { "fixed add Q4.12",   benches::arithmetic::fixed_add<fixed_q4_12>    },
         { "fixed add Q8.8",    benches::arithmetic::fixed_add<fixed_q8_8>     },
+        { "fixed add Q32.32",  benches::arithmetic::fixed_add<fixed_q32_32>   },
         { "float sub",         benches::arithmetic::float_sub                 },
         { "fixed sub Q16.16",  benches::arithmetic::fixed_sub<fixed_q16_16>   },
         { "fixed sub Q4.12",   benches::arithmetic::fixed_sub<fixed_q4_12>    },
         { "fixed sub Q8.8",    benches::arithmetic::fixed_sub<fixed_q8_8>     },
+        { "fixed sub Q32.32",  benches::arithmetic::fixed_sub<fixed_q32_32>   },
         { "float mul",         benches::arithmetic::float_mul                 },
         { "fixed mul Q16.16",  benches::arithmetic::fixed_mul<fixed_q16_16>   },
         { "fixed mul Q4.12",   benches::arithmetic::fixed_mul<fixed_q4_12>    },
         { "fixed mul Q8.8",    benches::arithmetic::fixed_mul<fixed_q8_8>     },
+        { "fixed mul Q32.32",  benches::arithmetic::fixed_mul<fixed_q32_32>   },
         { "float div",         benches::arithmetic::float_div                 },
         { "fixed div Q16.16",  benches::arithmetic::fixed_div<fixed_q16_16>   },
         { "fixed div Q4.12",   benches::arithmetic::fixed_div<fixed_q4_12>    },
         { "fixed div Q8.8",    benches::arithmetic::fixed_div<fixed_q8_8>     },
+        { "fixed div Q32.32",  benches::arithmetic::fixed_div<fixed_q32_32>   },
 
         { "to string Q16.16",  benches::util::fixed_to_string<fixed_q16_16>   },
         { "to string Q4.12",   benches::util::fixed_to_string<fixed_q4_12>    },
@@ -264,6 +1013,99 @@ int main(int argc, char *argv[])
         { "to C string Q4.12"   , benches::util::fixed_to_cstring<fixed_q4_12> },
         { "to C string Q8.8"    , benches::util::fixed_to_cstring<fixed_q8_8> },
 
+        { "fir 64-tap x1024 Q0.15"   , benches::dsp::fir_block<fixed_q0_15, 64, 1024> },
+        { "fir 64-tap x1024 Q16.16"  , benches::dsp::fir_block<fixed_q16_16, 64, 1024> },
+        { "fir 64-tap x1024 Q32.32"  , benches::dsp::fir_block<fixed_q32_32, 64, 1024> },
+        { "biquad 4-section 8ch x1024 Q0.15"  , benches::dsp::biquad_block<fixed_q0_15, 8, 1024> },
+        { "biquad 4-section 8ch x1024 Q16.16" , benches::dsp::biquad_block<fixed_q16_16, 8, 1024> },
+
+        { "from_float x8192 Q0.15"     , benches::convert::from_float_bulk<fixed_q0_15> },
+        { "fixed(float) x8192 Q0.15"   , benches::convert::from_float_classical<fixed_q0_15> },
+        { "from_float x8192 Q16.16"    , benches::convert::from_float_bulk<fixed_q16_16> },
+        { "fixed(float) x8192 Q16.16"  , benches::convert::from_float_classical<fixed_q16_16> },
+        { "to_float x8192 Q0.15"       , benches::convert::to_float_bulk<fixed_q0_15> },
+        { "to_float x8192 Q16.16"      , benches::convert::to_float_bulk<fixed_q16_16> },
+
+        { "divider x8192 Q4.12"        , benches::divide::divider_bulk<fixed_q4_12> },
+        { "operator/ x8192 Q4.12"      , benches::divide::operator_div<fixed_q4_12> },
+        { "divider x8192 Q16.16"       , benches::divide::divider_bulk<fixed_q16_16> },
+        { "operator/ x8192 Q16.16"     , benches::divide::operator_div<fixed_q16_16> },
+        { "divider x8192 Q32.32"       , benches::divide::divider_bulk<fixed_q32_32> },
+        { "operator/ x8192 Q32.32"     , benches::divide::operator_div<fixed_q32_32> },
+
+        { "div x8192 Q4.12"            , benches::divide::newton_div_bulk<fixed_q4_12, fixp::division_accuracy::exact> },
+        { "div faithful x8192 Q4.12"   , benches::divide::newton_div_bulk<fixed_q4_12, fixp::division_accuracy::faithful> },
+        { "a[i] / b[i] x8192 Q4.12"    , benches::divide::elementwise_div<fixed_q4_12> },
+        { "div x8192 Q16.16"           , benches::divide::newton_div_bulk<fixed_q16_16, fixp::division_accuracy::exact> },
+        { "div faithful x8192 Q16.16"  , benches::divide::newton_div_bulk<fixed_q16_16, fixp::division_accuracy::faithful> },
+        { "a[i] / b[i] x8192 Q16.16"   , benches::divide::elementwise_div<fixed_q16_16> },
+
+        { "fma x8192 Q0.15"            , benches::fma::fma_bulk<fixed_q0_15> },
+        { "a * b + c x8192 Q0.15"      , benches::fma::mul_add<fixed_q0_15> },
+        { "fma x8192 Q16.16"           , benches::fma::fma_bulk<fixed_q16_16> },
+        { "a * b + c x8192 Q16.16"     , benches::fma::mul_add<fixed_q16_16> },
+
+        { "poly x8192 Q4.12"           , benches::poly::evaluate_bulk<fixed_q4_12, fixp::poly_scheme::horner> },
+        { "poly estrin x8192 Q4.12"    , benches::poly::evaluate_bulk<fixed_q4_12, fixp::poly_scheme::estrin> },
+        { "operator Horner x8192 Q4.12", benches::poly::operator_horner<fixed_q4_12> },
+        { "poly x8192 Q16.16"          , benches::poly::evaluate_bulk<fixed_q16_16, fixp::poly_scheme::horner> },
+        { "poly estrin x8192 Q16.16"   , benches::poly::evaluate_bulk<fixed_q16_16, fixp::poly_scheme::estrin> },
+        { "operator Horner x8192 Q16.16", benches::poly::operator_horner<fixed_q16_16> },
+
+        { "expr a * x + b x8192 Q4.12" , benches::expr::fused<fixed_q4_12> },
+        { "two passes x8192 Q4.12"     , benches::expr::separate<fixed_q4_12> },
+        { "expr a * x + b x8192 Q16.16", benches::expr::fused<fixed_q16_16> },
+        { "two passes x8192 Q16.16"    , benches::expr::separate<fixed_q16_16> },
+
+        { "soa p += v * dt x8192 Q16.16", benches::soa::integrate_soa<fixed_q16_16> },
+        { "aos p += v * dt x8192 Q16.16", benches::soa::integrate_aos<fixed_q16_16> },
+        { "soa p += v * dt x8192 Q4.12", benches::soa::integrate_soa<fixed_q4_12> },
+        { "aos p += v * dt x8192 Q4.12", benches::soa::integrate_aos<fixed_q4_12> },
+
+        { "array add_saturate x100 Q0.15"  , benches::aligned::add_saturate_array<fixed_q0_15, 100> },
+        { "pointer add_saturate x100 Q0.15", benches::aligned::add_saturate_pointer<fixed_q0_15, 100> },
+        { "array add_saturate x1000 Q0.15" , benches::aligned::add_saturate_array<fixed_q0_15, 1000> },
+        { "pointer add_saturate x1000 Q0.15", benches::aligned::add_saturate_pointer<fixed_q0_15, 1000> },
+
+        { "mapped dataset open 1M Q16.16", benches::dataset::open_mapped<fixed_q16_16> },
+        { "ifstream read 1M Q16.16"    , benches::dataset::open_read<fixed_q16_16> },
+
+        { "unpack 12 bit x8192 Q4.12"  , benches::bitpacked::unpack<fixed_q4_12, 12> },
+        { "pack 12 bit x8192 Q4.12"    , benches::bitpacked::pack<fixed_q4_12, 12> },
+        { "copy x8192 Q4.12"           , benches::bitpacked::copy<fixed_q4_12> },
+        { "unpack 20 bit x8192 Q16.16" , benches::bitpacked::unpack<fixed_q16_16, 20> },
+        { "pack 20 bit x8192 Q16.16"   , benches::bitpacked::pack<fixed_q16_16, 20> },
+        { "copy x8192 Q16.16"          , benches::bitpacked::copy<fixed_q16_16> },
+        { "encode slow x8192 Q4.12"    , benches::codec::encode<fixed_q4_12> },
+        { "decode slow x8192 Q4.12"    , benches::codec::decode<fixed_q4_12> },
+        { "encode slow x8192 Q16.16"   , benches::codec::encode<fixed_q16_16> },
+        { "decode slow x8192 Q16.16"   , benches::codec::decode<fixed_q16_16> },
+        { "3 passes x8M Q4.12"         , benches::pipeline::passes<fixed_q4_12> },
+        { "pipeline x8M Q4.12"         , benches::pipeline::chunked<fixed_q4_12, false> },
+        { "pipeline threaded x8M Q4.12", benches::pipeline::chunked<fixed_q4_12, true> },
+        { "fma x1M Q16.16"             , benches::parallel::fma<fixed_q16_16, false> },
+        { "parallel fma x1M Q16.16"    , benches::parallel::fma<fixed_q16_16, true> },
+        { "dot x1M Q4.12"              , benches::parallel::dot<fixed_q4_12, false> },
+        { "parallel dot x1M Q4.12"     , benches::parallel::dot<fixed_q4_12, true> },
+        { "mixed jobs omp Q4.12"       , benches::pool::openmp<fixed_q4_12> },
+        { "mixed jobs pool Q4.12"      , benches::pool::stealing<fixed_q4_12> },
+
+        { "add_saturate x8192 UQ0.8"   , benches::saturate::add_saturate_bulk<fixed_uq0_8> },
+        { "clamped add x8192 UQ0.8"    , benches::saturate::add_saturate_classical<fixed_uq0_8> },
+        { "add_saturate x8192 UQ0.16"  , benches::saturate::add_saturate_bulk<fixed_uq0_16> },
+        { "clamped add x8192 UQ0.16"   , benches::saturate::add_saturate_classical<fixed_uq0_16> },
+        { "add_saturate x8192 Q0.15"   , benches::saturate::add_saturate_bulk<fixed_q0_15> },
+        { "clamped add x8192 Q0.15"    , benches::saturate::add_saturate_classical<fixed_q0_15> },
+
+        { "nco 16ch x1024 Q4.12"       , benches::nco::nco_block<fixed_q4_12, 16, 1024> },
+        { "sin 16ch x1024 Q4.12"       , benches::nco::sin_block<fixed_q4_12, 16, 1024> },
+
+        { "float fft 1024"             , benches::fft::float_fft<1024> },
+        { "fixed fft 1024 Q0.15"       , benches::fft::fixed_fft<fixed_q0_15, 1024> },
+        { "fixed fft 1024 Q16.16"      , benches::fft::fixed_fft<fixed_q16_16, 1024> },
+        { "fixed real fft 1024 Q0.15"  , benches::fft::fixed_rfft<fixed_q0_15, 1024> },
+        { "fixed real fft 1024 Q16.16" , benches::fft::fixed_rfft<fixed_q16_16, 1024> },
+
         { "simd mul 8-bit"       , benches::simd::bench_simd<std::int8_t, 8192>(benches::simd::mul_simd<std::int8_t>) },
         { "classical mul 8-bit"  , benches::simd::bench_simd<std::int8_t, 8192>(benches::simd::mul_classical<std::int8_t>) },
         { "simd mul 16-bit"      , benches::simd::bench_simd<std::int16_t, 8192>(benches::simd::mul_simd<std::int16_t>) },
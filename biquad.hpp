@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <fixp.hpp>
+#include <limits>
+#include <type_traits>
+
+namespace fixp::dsp {
+    enum class biquad_form {
+        // Direct form I, feeding the quantization error of each
+        // output back into the next one (first order noise shaping)
+        df1_error_feedback,
+        // Transposed direct form II with full precision state
+        transposed_df2,
+    };
+
+    // y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+    //
+    // Coefficients usually need more integral headroom than the
+    // samples (|a1| may be up to 2), hence a separate format.
+    template<is_fixed Coeff>
+    struct biquad_coefficients {
+        Coeff b0, b1, b2, a1, a2;
+    };
+
+    namespace detail {
+        template<is_signed_integer A, is_signed_integer B>
+        using wider_t = std::conditional_t<(sizeof(A) >= sizeof(B)), A, B>;
+
+        // Outputs past full scale saturate rather than wrap, which
+        // inside the feedback loop would flip the sign of the state
+        template<is_signed_integer Storage, is_signed_integer Accumulator>
+        FIXP_ALWAYS_INLINE static constexpr Storage
+        saturate(Accumulator x) {
+            return static_cast<Storage>(std::clamp<Accumulator>(x, std::numeric_limits<Storage>::min(), std::numeric_limits<Storage>::max()));
+        }
+    }
+
+    // A cascade of second order sections applied to Channels
+    // independent, interleaved channels (in[frame * Channels +
+    // channel]). All channels share the same coefficients; their state
+    // is laid out channel-contiguous so each step of the recurrence is
+    // a vector operation across channels.
+    template<is_fixed T,
+             const std::size_t Sections,
+             const std::size_t Channels = 1,
+             const biquad_form Form = biquad_form::df1_error_feedback,
+             is_fixed Coeff = T,
+             is_signed_integer Accumulator = detail::wider_t<accumulator_t<T>, accumulator_t<Coeff>>>
+    requires (Sections > 0 && Channels > 0)
+    class biquad_cascade final {
+        public:
+            using value_type = T;
+            using coefficient_type = Coeff;
+            using coefficients = biquad_coefficients<Coeff>;
+
+            static constexpr biquad_form form = Form;
+
+        private:
+            using Storage = typename T::storage_type;
+
+            static constexpr std::size_t Shift = Coeff::FracBits;
+
+            struct section_state {
+                // Direct form I
+                std::array<Storage, Channels> x1, x2, y1, y2;
+                std::array<Accumulator, Channels> error;
+
+                // Transposed direct form II, kept at the full
+                // precision of the products
+                std::array<Accumulator, Channels> s1, s2;
+            };
+
+            std::array<coefficients, Sections> sections;
+            std::array<section_state, Sections> state;
+
+            static constexpr Accumulator
+            mul(Accumulator x, const Coeff& c) {
+                return x * static_cast<Accumulator>(c.raw);
+            }
+
+            void df1(std::size_t s, T* data, std::size_t frames) {
+                const coefficients& c = sections[s];
+                section_state& st = state[s];
+
+                for (std::size_t n = 0; n < frames; n++) {
+                    T* frame = &data[n * Channels];
+
+                    #pragma omp simd
+                    for (std::size_t ch = 0; ch < Channels; ch++) {
+                        const Accumulator x = frame[ch].raw;
+
+                        const Accumulator acc = mul(x, c.b0)
+                            + mul(st.x1[ch], c.b1)
+                            + mul(st.x2[ch], c.b2)
+                            - mul(st.y1[ch], c.a1)
+                            - mul(st.y2[ch], c.a2)
+                            + st.error[ch];
+
+                        const Accumulator y = acc >> Shift;
+                        const Storage out = detail::saturate<Storage>(y);
+
+                        st.error[ch] = acc - (y << Shift);
+                        st.x2[ch] = st.x1[ch];
+                        st.x1[ch] = static_cast<Storage>(x);
+                        st.y2[ch] = st.y1[ch];
+                        st.y1[ch] = out;
+
+                        frame[ch].raw = out;
+                    }
+                }
+            }
+
+            void tdf2(std::size_t s, T* data, std::size_t frames) {
+                constexpr Accumulator half = Shift > 0 ? static_cast<Accumulator>(1) << (Shift - 1) : 0;
+
+                const coefficients& c = sections[s];
+                section_state& st = state[s];
+
+                for (std::size_t n = 0; n < frames; n++) {
+                    T* frame = &data[n * Channels];
+
+                    #pragma omp simd
+                    for (std::size_t ch = 0; ch < Channels; ch++) {
+                        const Accumulator x = frame[ch].raw;
+                        const Accumulator y = detail::saturate<Storage>((mul(x, c.b0) + st.s1[ch] + half) >> Shift);
+
+                        st.s1[ch] = mul(x, c.b1) - mul(y, c.a1) + st.s2[ch];
+                        st.s2[ch] = mul(x, c.b2) - mul(y, c.a2);
+
+                        frame[ch].raw = static_cast<Storage>(y);
+                    }
+                }
+            }
+
+        public:
+            constexpr biquad_cascade(const std::array<coefficients, Sections>& sections)
+                : sections(sections) {
+                reset();
+            }
+
+            constexpr void reset() {
+                for (auto& st : state) {
+                    st.x1.fill(0);
+                    st.x2.fill(0);
+                    st.y1.fill(0);
+                    st.y2.fill(0);
+                    st.error.fill(0);
+                    st.s1.fill(0);
+                    st.s2.fill(0);
+                }
+            }
+
+            // Filter frames * Channels interleaved samples. The cascade
+            // is applied section by section over the whole block, so
+            // in and out may alias.
+            void process(const T* in, T* out, std::size_t frames) {
+                if (in != out) {
+                    for (std::size_t i = 0; i < frames * Channels; i++) {
+                        out[i] = in[i];
+                    }
+                }
+
+                for (std::size_t s = 0; s < Sections; s++) {
+                    if constexpr (Form == biquad_form::df1_error_feedback) {
+                        df1(s, out, frames);
+                    } else {
+                        tdf2(s, out, frames);
+                    }
+                }
+            }
+    };
+}
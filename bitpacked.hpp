@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+#include <aligned.hpp>
+#include <fixp.hpp>
+
+// Dense storage for values that only use the low Bits bits of their
+// storage type, e.g. 12 bit samples in a fixed_q4_12.
+//
+// Values are packed in blocks of 256 with the lane interleaved layout
+// of Lemire and Boytsov's SIMD-BP128: value r * 8 + l of a block lives
+// in lane l of a group of eight 32 bit words, and rows of Bits bits are
+// laid end to end down each lane. Packing and unpacking are then the
+// same shifts and masks applied to eight independent lanes, which the
+// compiler turns into straight vector code (one AVX2 register, or two
+// NEON registers per step) with no shuffles, and the format does not
+// depend on the target.
+namespace fixp {
+    namespace detail::packing {
+        static constexpr std::size_t Lanes = 8;
+        static constexpr std::size_t Rows = 32;
+        static constexpr std::size_t BlockSize = Lanes * Rows;
+
+        template<std::size_t Bits>
+        static constexpr std::uint32_t Mask = Bits == 32 ? ~std::uint32_t { 0 } : (std::uint32_t { 1 } << Bits) - 1;
+
+        // Packs BlockSize values into Bits * Lanes words. Bits above
+        // Bits in the input are ignored
+        template<std::size_t Bits>
+        static inline void
+        pack_block(const std::uint32_t* in, std::uint32_t* out) {
+            std::uint32_t acc[Lanes] = {};
+
+            [&]<std::size_t... R>(std::index_sequence<R...>) {
+                ([&] {
+                    constexpr std::size_t Word = R * Bits / 32;
+                    constexpr std::size_t Shift = R * Bits % 32;
+
+                    #pragma omp simd
+                    for (std::size_t l = 0; l < Lanes; l++) {
+                        acc[l] |= (in[R * Lanes + l] & Mask<Bits>) << Shift;
+                    }
+
+                    if constexpr (Shift + Bits >= 32) {
+                        #pragma omp simd
+                        for (std::size_t l = 0; l < Lanes; l++) {
+                            out[Word * Lanes + l] = acc[l];
+
+                            if constexpr (Shift + Bits > 32) {
+                                acc[l] = (in[R * Lanes + l] & Mask<Bits>) >> (32 - Shift);
+                            } else {
+                                acc[l] = 0;
+                            }
+                        }
+                    }
+                }(), ...);
+            }(std::make_index_sequence<Rows> {});
+        }
+
+        // Unpacks Bits * Lanes words into BlockSize values
+        template<std::size_t Bits>
+        static inline void
+        unpack_block(const std::uint32_t* in, std::uint32_t* out) {
+            [&]<std::size_t... R>(std::index_sequence<R...>) {
+                ([&] {
+                    constexpr std::size_t Word = R * Bits / 32;
+                    constexpr std::size_t Shift = R * Bits % 32;
+
+                    #pragma omp simd
+                    for (std::size_t l = 0; l < Lanes; l++) {
+                        std::uint32_t v = in[Word * Lanes + l] >> Shift;
+
+                        if constexpr (Shift + Bits > 32) {
+                            v |= in[(Word + 1) * Lanes + l] << (32 - Shift);
+                        }
+
+                        out[R * Lanes + l] = v & Mask<Bits>;
+                    }
+                }(), ...);
+            }(std::make_index_sequence<Rows> {});
+        }
+
+        // Raw value to its low Bits bits and back again, sign extending
+        // for signed formats
+        template<is_fixed T>
+        static constexpr std::uint32_t to_word(const T& x) {
+            return static_cast<std::uint32_t>(x.raw);
+        }
+
+        template<is_fixed T, std::size_t Bits>
+        static constexpr T from_word(std::uint32_t w) {
+            using Storage = typename T::storage_type;
+
+            if constexpr (is_signed_integer<Storage> && Bits < 32) {
+                constexpr int Unused = 32 - static_cast<int>(Bits);
+                return T::from_raw(static_cast<Storage>(static_cast<std::int32_t>(w << Unused) >> Unused));
+            } else {
+                return T::from_raw(static_cast<Storage>(w));
+            }
+        }
+    }
+
+    // Number of 32 bit words pack() writes for n values
+    template<std::size_t Bits>
+    static constexpr std::size_t packed_words(std::size_t n) {
+        return (n + detail::packing::BlockSize - 1) / detail::packing::BlockSize * Bits * detail::packing::Lanes;
+    }
+
+    // Packs the low Bits bits of every raw value in in into
+    // packed_words<Bits>(n) words. Signed values must fit in Bits bits
+    // of two's complement, and unsigned ones in Bits bits, to come back
+    // unchanged
+    template<std::size_t Bits, is_fixed T>
+    requires (Bits > 0 && Bits <= 32 && sizeof(typename T::storage_type) <= 4)
+    static inline void
+    pack(const T* in, std::uint32_t* out, std::size_t n) {
+        using namespace detail::packing;
+
+        std::uint32_t block[BlockSize];
+
+        for (std::size_t i = 0; i < n; i += BlockSize) {
+            const std::size_t m = std::min(BlockSize, n - i);
+
+            #pragma omp simd
+            for (std::size_t j = 0; j < m; j++) {
+                block[j] = to_word(in[i + j]);
+            }
+
+            std::fill(block + m, block + BlockSize, 0);
+            pack_block<Bits>(block, out + i / BlockSize * Bits * Lanes);
+        }
+    }
+
+    template<std::size_t Bits, is_fixed T>
+    requires (Bits > 0 && Bits <= 32 && sizeof(typename T::storage_type) <= 4)
+    static inline void
+    unpack(const std::uint32_t* in, T* out, std::size_t n) {
+        using namespace detail::packing;
+
+        std::uint32_t block[BlockSize];
+
+        for (std::size_t i = 0; i < n; i += BlockSize) {
+            const std::size_t m = std::min(BlockSize, n - i);
+
+            unpack_block<Bits>(in + i / BlockSize * Bits * Lanes, block);
+
+            #pragma omp simd
+            for (std::size_t j = 0; j < m; j++) {
+                out[i + j] = from_word<T, Bits>(block[j]);
+            }
+        }
+    }
+
+    // A container of n values of T held in Bits bits each, e.g.
+    // bitpacked<fixed_q4_12, 12> for 12 bit samples at three quarters of
+    // the memory. Whole arrays move in and out with pack() and
+    // unpack(), single elements with get() and set()
+    template<is_fixed T, const std::size_t Bits>
+    requires (Bits > 0 && Bits <= 32 && sizeof(typename T::storage_type) <= 4)
+    class bitpacked {
+        private:
+            std::vector<std::uint32_t, aligned_allocator<std::uint32_t>> words;
+            std::size_t count = 0;
+
+            // Word and shift of element i
+            static constexpr std::pair<std::size_t, std::size_t> locate(std::size_t i) {
+                using namespace detail::packing;
+
+                const std::size_t row = i % BlockSize / Lanes;
+                const std::size_t lane = i % Lanes;
+                const std::size_t bit = row * Bits;
+
+                return { i / BlockSize * Bits * Lanes + bit / 32 * Lanes + lane, bit % 32 };
+            }
+
+        public:
+            using value_type = T;
+            static constexpr std::size_t ValueBits = Bits;
+
+            bitpacked() = default;
+
+            // n zeros
+            explicit bitpacked(std::size_t n) : words(packed_words<Bits>(n)), count(n) {}
+
+            explicit bitpacked(std::span<const T> values) : bitpacked(values.size()) {
+                fixp::pack<Bits>(values.data(), words.data(), count);
+            }
+
+            std::size_t size() const { return count; }
+
+            // Memory used by the values
+            std::size_t size_bytes() const { return words.size() * sizeof(std::uint32_t); }
+
+            const std::uint32_t* data() const { return words.data(); }
+            std::uint32_t* data() { return words.data(); }
+
+            // Overwrites the contents with values, resizing to match
+            void pack(std::span<const T> values) {
+                words.assign(packed_words<Bits>(values.size()), 0);
+                count = values.size();
+                fixp::pack<Bits>(values.data(), words.data(), count);
+            }
+
+            // Writes all size() values to out
+            void unpack(T* out) const {
+                fixp::unpack<Bits>(words.data(), out, count);
+            }
+
+            T get(std::size_t i) const {
+                const auto [w, shift] = locate(i);
+
+                std::uint32_t v = words[w] >> shift;
+                if (shift + Bits > 32) {
+                    v |= words[w + detail::packing::Lanes] << (32 - shift);
+                }
+
+                return detail::packing::from_word<T, Bits>(v & detail::packing::Mask<Bits>);
+            }
+
+            void set(std::size_t i, const T& x) {
+                const auto [w, shift] = locate(i);
+                const std::uint64_t v = detail::packing::to_word(x) & detail::packing::Mask<Bits>;
+                const std::uint64_t mask = std::uint64_t { detail::packing::Mask<Bits> } << shift;
+
+                words[w] = static_cast<std::uint32_t>((words[w] & ~mask) | (v << shift));
+                if (shift + Bits > 32) {
+                    const std::size_t next = w + detail::packing::Lanes;
+                    words[next] = static_cast<std::uint32_t>((words[next] & ~(mask >> 32)) | (v << shift >> 32));
+                }
+            }
+
+            T operator[](std::size_t i) const { return get(i); }
+    };
+}
@@ -0,0 +1,448 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <fixp.hpp>
+#include <hints.hpp>
+#include <limits>
+#include <utility>
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Bulk kernels over arrays of fixed values
+namespace fixp {
+    enum class overflow {
+        // The caller guarantees that every value is in range
+        unchecked,
+        // Clamp to the storage range, NaN becomes 0
+        saturate,
+    };
+
+    namespace detail::bulk {
+        template<rounding Rounding, overflow Overflow, is_fixed T, std::floating_point F>
+        FIXP_ALWAYS_INLINE static inline typename T::storage_type
+        from_float(F x) {
+            using Storage = typename T::storage_type;
+
+            constexpr F Lo = static_cast<F>(std::numeric_limits<Storage>::min());
+            constexpr F Hi = static_cast<F>(std::numeric_limits<Storage>::max());
+
+            x *= static_cast<F>(T::Scale);
+
+            if constexpr (Rounding == rounding::nearest) {
+                x = std::nearbyint(x);
+            }
+
+            if constexpr (Overflow == overflow::saturate) {
+                // Hi may have rounded up past the real maximum (2^31
+                // for int32), so compare rather than clamp
+                if (x >= Hi) {
+                    return std::numeric_limits<Storage>::max();
+                } else if (x <= Lo) {
+                    return std::numeric_limits<Storage>::min();
+                } else if (x != x) {
+                    return 0;
+                }
+            }
+
+            return static_cast<Storage>(x);
+        }
+
+        // a + b or a - b clamped to the range of S
+        template<bool Subtract, is_integer S>
+        FIXP_ALWAYS_INLINE static inline S
+        saturating_add(S a, S b) {
+            constexpr S Lo = std::numeric_limits<S>::min();
+            constexpr S Hi = std::numeric_limits<S>::max();
+
+            if constexpr (sizeof(S) < sizeof(std::int64_t)) {
+                const std::int64_t wide = Subtract
+                    ? static_cast<std::int64_t>(a) - static_cast<std::int64_t>(b)
+                    : static_cast<std::int64_t>(a) + static_cast<std::int64_t>(b);
+
+                return static_cast<S>(std::clamp<std::int64_t>(wide, Lo, Hi));
+            } else {
+                S result;
+                const bool overflowed = Subtract
+                    ? __builtin_sub_overflow(a, b, &result)
+                    : __builtin_add_overflow(a, b, &result);
+
+                if (overflowed) {
+                    if constexpr (is_unsigned_integer<S>) {
+                        return Subtract ? Lo : Hi;
+                    } else {
+                        return a < 0 ? Lo : Hi;
+                    }
+                }
+
+                return result;
+            }
+        }
+
+        // out[i] = fma(a[i], b[i] or b[0], c[i]). The NEON paths use
+        // widening multiply-accumulate (vmlal) onto c pre-shifted by a
+        // widening shift, then narrow with a single shift.
+        template<rounding Rounding, bool BroadcastB, is_fixed T>
+        static inline void
+        fma(const T* a, const T* b, const T* c, T* out, std::size_t n) {
+            std::size_t i = 0;
+
+            #ifdef __ARM_NEON
+            using Storage = typename T::storage_type;
+            using Intermediate = typename T::intermediate_type;
+
+            constexpr int Shift = T::FracBits;
+
+            if constexpr (std::same_as<Storage, std::int16_t> && std::same_as<Intermediate, std::int32_t> && Shift > 0) {
+                const auto narrow = [](int32x4_t acc) {
+                    if constexpr (Rounding == rounding::nearest) {
+                        const int32x4_t odd = vandq_s32(vshrq_n_s32(acc, Shift), vdupq_n_s32(1));
+                        acc = vaddq_s32(acc, vaddq_s32(vdupq_n_s32((1 << (Shift - 1)) - 1), odd));
+                    }
+
+                    return vshrn_n_s32(acc, Shift);
+                };
+
+                for (; i + 8 <= n; i += 8) {
+                    const int16x8_t va = vld1q_s16(&a[i].raw);
+                    const int16x8_t vb = BroadcastB ? vdupq_n_s16(b[0].raw) : vld1q_s16(&b[i].raw);
+                    const int16x8_t vc = vld1q_s16(&c[i].raw);
+
+                    const int32x4_t lo = vmlal_s16(vshll_n_s16(vget_low_s16(vc), Shift), vget_low_s16(va), vget_low_s16(vb));
+                    const int32x4_t hi = vmlal_high_s16(vshll_high_n_s16(vc, Shift), va, vb);
+
+                    vst1q_s16(&out[i].raw, vcombine_s16(narrow(lo), narrow(hi)));
+                }
+            } else if constexpr (std::same_as<Storage, std::int32_t> && std::same_as<Intermediate, std::int64_t> && Shift > 0) {
+                const auto narrow = [](int64x2_t acc) {
+                    if constexpr (Rounding == rounding::nearest) {
+                        const int64x2_t odd = vandq_s64(vshrq_n_s64(acc, Shift), vdupq_n_s64(1));
+                        acc = vaddq_s64(acc, vaddq_s64(vdupq_n_s64((std::int64_t { 1 } << (Shift - 1)) - 1), odd));
+                    }
+
+                    return vshrn_n_s64(acc, Shift);
+                };
+
+                for (; i + 4 <= n; i += 4) {
+                    const int32x4_t va = vld1q_s32(&a[i].raw);
+                    const int32x4_t vb = BroadcastB ? vdupq_n_s32(b[0].raw) : vld1q_s32(&b[i].raw);
+                    const int32x4_t vc = vld1q_s32(&c[i].raw);
+
+                    const int64x2_t lo = vmlal_s32(vshll_n_s32(vget_low_s32(vc), Shift), vget_low_s32(va), vget_low_s32(vb));
+                    const int64x2_t hi = vmlal_high_s32(vshll_high_n_s32(vc, Shift), va, vb);
+
+                    vst1q_s32(&out[i].raw, vcombine_s32(narrow(lo), narrow(hi)));
+                }
+            }
+            #endif
+
+            #pragma omp simd
+            for (std::size_t j = i; j < n; j++) {
+                out[j] = fixp::fma<Rounding>(a[j], BroadcastB ? b[0] : b[j], c[j]);
+            }
+        }
+
+        // out[i] = Poly::evaluate(in[i]). The NEON path runs Horner's
+        // scheme for Q*.15 and narrower 16 bit formats, with the
+        // accumulator in 32 bit lanes and products in 64 bit lanes
+        // narrowed with a rounding shift, like the scalar version.
+        template<typename Poly, poly_scheme Scheme, rounding Rounding, is_fixed T>
+        static inline void
+        evaluate(const T* in, T* out, std::size_t n) {
+            std::size_t i = 0;
+
+            #ifdef __ARM_NEON
+            using Storage = typename T::storage_type;
+            using Intermediate = typename T::intermediate_type;
+            using format = detail::poly_format<T>;
+
+            constexpr int Shift = T::FracBits;
+
+            if constexpr (Scheme == poly_scheme::horner && std::same_as<Storage, std::int16_t>
+                          && std::same_as<Intermediate, std::int32_t> && Shift > 0 && format::GuardBits == Shift) {
+                constexpr auto& c = Poly::template coefficients<T>;
+                constexpr std::size_t N = c.size();
+
+                const auto horner = [&c](int32x4_t x) {
+                    int32x4_t acc = vdupq_n_s32(c[N - 1]);
+
+                    const auto step = [&](std::int32_t ck) {
+                        const int64x2_t lo = vmull_s32(vget_low_s32(acc), vget_low_s32(x));
+                        const int64x2_t hi = vmull_high_s32(acc, x);
+                        acc = vaddq_s32(vcombine_s32(vrshrn_n_s64(lo, Shift), vrshrn_n_s64(hi, Shift)), vdupq_n_s32(ck));
+                    };
+
+                    [&]<std::size_t... K>(std::index_sequence<K...>) {
+                        (step(c[N - 2 - K]), ...);
+                    }(std::make_index_sequence<N - 1> {});
+
+                    if constexpr (Rounding == rounding::nearest) {
+                        const int32x4_t odd = vandq_s32(vshrq_n_s32(acc, Shift), vdupq_n_s32(1));
+                        acc = vaddq_s32(acc, vaddq_s32(vdupq_n_s32((1 << (Shift - 1)) - 1), odd));
+                    }
+
+                    return vshrn_n_s32(acc, Shift);
+                };
+
+                for (; i + 8 <= n; i += 8) {
+                    const int16x8_t v = vld1q_s16(&in[i].raw);
+                    vst1q_s16(&out[i].raw, vcombine_s16(horner(vmovl_s16(vget_low_s16(v))), horner(vmovl_high_s16(v))));
+                }
+            }
+            #endif
+
+            #pragma omp simd
+            for (std::size_t j = i; j < n; j++) {
+                out[j] = Poly::template evaluate<Scheme, Rounding>(in[j]);
+            }
+        }
+
+        // With Aligned every pointer is aligned to at least 32 bytes
+        template<bool Subtract, bool Aligned = false, is_fixed T>
+        static inline void
+        saturating_add(const T* a, const T* b, T* out, std::size_t n) {
+            std::size_t i = 0;
+
+            #ifdef __ARM_NEON
+            using Storage = typename T::storage_type;
+
+            #define FIXP_SATURATING_ADD(SCALAR, SUFFIX, LANES)                          \
+                if constexpr (std::same_as<Storage, SCALAR>) {                          \
+                    for (; i + LANES <= n; i += LANES) {                                \
+                        const auto va = vld1q_##SUFFIX(&a[i].raw);                      \
+                        const auto vb = vld1q_##SUFFIX(&b[i].raw);                      \
+                        vst1q_##SUFFIX(&out[i].raw, Subtract ? vqsubq_##SUFFIX(va, vb)  \
+                                                             : vqaddq_##SUFFIX(va, vb)); \
+                    }                                                                   \
+                }
+
+            FIXP_SATURATING_ADD(std::uint8_t,  u8,  16)
+            FIXP_SATURATING_ADD(std::int8_t,   s8,  16)
+            FIXP_SATURATING_ADD(std::uint16_t, u16, 8)
+            FIXP_SATURATING_ADD(std::int16_t,  s16, 8)
+            FIXP_SATURATING_ADD(std::uint32_t, u32, 4)
+            FIXP_SATURATING_ADD(std::int32_t,  s32, 4)
+            FIXP_SATURATING_ADD(std::uint64_t, u64, 2)
+            FIXP_SATURATING_ADD(std::int64_t,  s64, 2)
+            #undef FIXP_SATURATING_ADD
+            #elif defined(__AVX2__)
+            using Storage = typename T::storage_type;
+
+            const auto load = [](const __m256i* p) {
+                return Aligned ? _mm256_load_si256(p) : _mm256_loadu_si256(p);
+            };
+
+            const auto store = [](__m256i* p, __m256i v) {
+                if constexpr (Aligned) {
+                    _mm256_store_si256(p, v);
+                } else {
+                    _mm256_storeu_si256(p, v);
+                }
+            };
+
+            // AVX2 only saturates 8 and 16 bit lanes
+            #define FIXP_SATURATING_ADD(SCALAR, SUFFIX)                                                    \
+                if constexpr (std::same_as<Storage, SCALAR>) {                                             \
+                    for (; i + 32 / sizeof(SCALAR) <= n; i += 32 / sizeof(SCALAR)) {                       \
+                        const __m256i va = load(reinterpret_cast<const __m256i*>(&a[i].raw));              \
+                        const __m256i vb = load(reinterpret_cast<const __m256i*>(&b[i].raw));              \
+                        store(reinterpret_cast<__m256i*>(&out[i].raw),                                     \
+                              Subtract ? _mm256_subs_##SUFFIX(va, vb)                                      \
+                                       : _mm256_adds_##SUFFIX(va, vb));                                    \
+                    }                                                                                      \
+                }
+
+            FIXP_SATURATING_ADD(std::uint8_t,  epu8)
+            FIXP_SATURATING_ADD(std::int8_t,   epi8)
+            FIXP_SATURATING_ADD(std::uint16_t, epu16)
+            FIXP_SATURATING_ADD(std::int16_t,  epi16)
+            #undef FIXP_SATURATING_ADD
+            #endif
+
+            #pragma omp simd
+            for (std::size_t j = i; j < n; j++) {
+                out[j] = T::from_raw(saturating_add<Subtract>(a[j].raw, b[j].raw));
+            }
+        }
+    }
+
+    // out[i] = in[i] converted to T. The NEON paths use the saturating
+    // convert instructions, which have the same semantics as the
+    // scalar path.
+    template<rounding Rounding = rounding::nearest,
+             overflow Overflow = overflow::saturate,
+             std::floating_point F,
+             is_fixed T>
+    static inline void
+    from_float(const F* in, T* out, std::size_t n) {
+        std::size_t i = 0;
+
+        #ifdef __ARM_NEON
+        using Storage = typename T::storage_type;
+
+        constexpr float scale = static_cast<float>(T::Scale);
+
+        const auto convert_f32 = [](float32x4_t v) {
+            v = vmulq_n_f32(v, scale);
+            return Rounding == rounding::nearest ? vcvtnq_s32_f32(v) : vcvtq_s32_f32(v);
+        };
+
+        if constexpr (std::same_as<F, float> && std::same_as<Storage, std::int16_t>) {
+            for (; i + 8 <= n; i += 8) {
+                const int32x4_t lo = convert_f32(vld1q_f32(&in[i]));
+                const int32x4_t hi = convert_f32(vld1q_f32(&in[i + 4]));
+
+                if constexpr (Overflow == overflow::saturate) {
+                    vst1q_s16(&out[i].raw, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+                } else {
+                    vst1q_s16(&out[i].raw, vcombine_s16(vmovn_s32(lo), vmovn_s32(hi)));
+                }
+            }
+        } else if constexpr (std::same_as<F, float> && std::same_as<Storage, std::int32_t>) {
+            for (; i + 4 <= n; i += 4) {
+                vst1q_s32(&out[i].raw, convert_f32(vld1q_f32(&in[i])));
+            }
+        } else if constexpr (std::same_as<F, double> && std::same_as<Storage, std::int32_t>) {
+            for (; i + 4 <= n; i += 4) {
+                float64x2_t lo = vmulq_n_f64(vld1q_f64(&in[i]), static_cast<double>(T::Scale));
+                float64x2_t hi = vmulq_n_f64(vld1q_f64(&in[i + 2]), static_cast<double>(T::Scale));
+
+                const int64x2_t ilo = Rounding == rounding::nearest ? vcvtnq_s64_f64(lo) : vcvtq_s64_f64(lo);
+                const int64x2_t ihi = Rounding == rounding::nearest ? vcvtnq_s64_f64(hi) : vcvtq_s64_f64(hi);
+
+                if constexpr (Overflow == overflow::saturate) {
+                    vst1q_s32(&out[i].raw, vcombine_s32(vqmovn_s64(ilo), vqmovn_s64(ihi)));
+                } else {
+                    vst1q_s32(&out[i].raw, vcombine_s32(vmovn_s64(ilo), vmovn_s64(ihi)));
+                }
+            }
+        }
+        #endif
+
+        #pragma omp simd
+        for (std::size_t j = i; j < n; j++) {
+            out[j] = T::from_raw(detail::bulk::from_float<Rounding, Overflow, T>(in[j]));
+        }
+    }
+
+    // out[i] = in[i] as F, exact up to the precision of F
+    template<is_fixed T, std::floating_point F>
+    static inline void
+    to_float(const T* in, F* out, std::size_t n) {
+        constexpr F inverse_scale = static_cast<F>(1) / static_cast<F>(T::Scale);
+        std::size_t i = 0;
+
+        #ifdef __ARM_NEON
+        using Storage = typename T::storage_type;
+
+        if constexpr (std::same_as<F, float> && std::same_as<Storage, std::int16_t>) {
+            for (; i + 8 <= n; i += 8) {
+                const int16x8_t v = vld1q_s16(&in[i].raw);
+
+                vst1q_f32(&out[i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), inverse_scale));
+                vst1q_f32(&out[i + 4], vmulq_n_f32(vcvtq_f32_s32(vmovl_high_s16(v)), inverse_scale));
+            }
+        } else if constexpr (std::same_as<F, float> && std::same_as<Storage, std::int32_t>) {
+            for (; i + 4 <= n; i += 4) {
+                vst1q_f32(&out[i], vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(&in[i].raw)), inverse_scale));
+            }
+        } else if constexpr (std::same_as<F, double> && std::same_as<Storage, std::int32_t>) {
+            for (; i + 4 <= n; i += 4) {
+                const int32x4_t v = vld1q_s32(&in[i].raw);
+
+                vst1q_f64(&out[i], vmulq_n_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(v))), inverse_scale));
+                vst1q_f64(&out[i + 2], vmulq_n_f64(vcvtq_f64_s64(vmovl_high_s32(v)), inverse_scale));
+            }
+        }
+        #endif
+
+        #pragma omp simd
+        for (std::size_t j = i; j < n; j++) {
+            out[j] = static_cast<F>(in[j].raw) * inverse_scale;
+        }
+    }
+
+    // out[i] = a[i] + b[i], clamped to the range of T instead of
+    // wrapping. Mostly useful for narrow (UQ0.8, Q0.15, ...) formats,
+    // which have saturating vector instructions on NEON and AVX2.
+    template<is_fixed T>
+    static inline void
+    add_saturate(const T* a, const T* b, T* out, std::size_t n) {
+        detail::bulk::saturating_add<false>(a, b, out, n);
+    }
+
+    // out[i] = a[i] - b[i], clamped to the range of T. For unsigned
+    // formats a negative difference becomes 0.
+    template<is_fixed T>
+    static inline void
+    sub_saturate(const T* a, const T* b, T* out, std::size_t n) {
+        detail::bulk::saturating_add<true>(a, b, out, n);
+    }
+
+    // out[i] = in[i] converted to another format, e.g. UQ8.8 to Q8.8.
+    // With overflow::saturate values outside the range of To are
+    // clamped (see saturate_cast), otherwise they wrap.
+    template<overflow Overflow = overflow::saturate, is_fixed From, is_fixed To>
+    static inline void
+    convert(const From* in, To* out, std::size_t n) {
+        #pragma omp simd
+        for (std::size_t i = 0; i < n; i++) {
+            if constexpr (Overflow == overflow::saturate) {
+                out[i] = saturate_cast<To>(in[i]);
+            } else {
+                out[i] = To(in[i]);
+            }
+        }
+    }
+
+    // out[i] = fma(a[i], b[i], c[i]), one rounding per element
+    template<rounding Rounding = rounding::nearest, is_fixed T>
+    static inline void
+    fma(const T* a, const T* b, const T* c, T* out, std::size_t n) {
+        detail::bulk::fma<Rounding, false>(a, b, c, out, n);
+    }
+
+    // out[i] = fma(a[i], b, c[i]), e.g. one step of a filter or of a
+    // polynomial evaluated across many points
+    template<rounding Rounding = rounding::nearest, is_fixed T>
+    static inline void
+    fma(const T* a, const T& b, const T* c, T* out, std::size_t n) {
+        detail::bulk::fma<Rounding, true>(a, &b, c, out, n);
+    }
+
+    // out[i] = Poly::evaluate(in[i]) for a fixp::poly, e.g.
+    //
+    //   fixp::evaluate<fixp::poly<1.0, 0.5, 0.125>>(x, y, n);
+    template<typename Poly, poly_scheme Scheme = poly_scheme::horner, rounding Rounding = rounding::nearest, is_fixed T>
+    static inline void
+    evaluate(const T* in, T* out, std::size_t n) {
+        detail::bulk::evaluate<Poly, Scheme, Rounding>(in, out, n);
+    }
+}
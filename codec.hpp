@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <utility>
+#include <vector>
+#include <bitpacked.hpp>
+#include <fixp.hpp>
+
+// Lossless block compression for streams of fixed values that change
+// slowly, e.g. telemetry. Every 256 values are coded one of two ways,
+// whichever needs fewer bits:
+//
+//  - frame of reference: each value minus the smallest in the block
+//  - delta: each value minus the one 8 places before it (the first 8
+//    minus the first value), zigzag coded so small negative steps are
+//    small too
+//
+// and the results bit-packed at the width of the largest. Deltas at a
+// stride of 8 match the lanes of the bitpacked.hpp layout, so undoing
+// them is a running sum down each lane, which vectorizes like the rest
+// of the decoder.
+//
+// A block is a header word (width, mode, count), a base word and
+// width * 8 payload words. Raw values round trip exactly, and a
+// malformed or truncated buffer is reported as a codec_error rather
+// than read out of bounds.
+namespace fixp {
+    enum class block_mode : std::uint8_t {
+        frame_of_reference = 0,
+        delta = 1,
+    };
+
+    enum class codec_error {
+        // A block header with a width above 32 or bits set that no
+        // encoder writes
+        bad_header,
+        // The buffer ends before the block it has started
+        truncated,
+    };
+
+    namespace detail::codec {
+        using namespace detail::packing;
+
+        static constexpr std::size_t HeaderWords = 2;
+
+        // Sign flipped for signed formats, so that unsigned order on
+        // the result is the order of the values
+        template<is_fixed T>
+        static constexpr std::uint32_t OrderFlip = is_signed_integer<typename T::storage_type> ? 0x80000000u : 0u;
+
+        static constexpr std::uint32_t zigzag(std::uint32_t d) {
+            return (d << 1) ^ static_cast<std::uint32_t>(static_cast<std::int32_t>(d) >> 31);
+        }
+
+        static constexpr std::uint32_t unzigzag(std::uint32_t z) {
+            return (z >> 1) ^ (0u - (z & 1));
+        }
+
+        using block_kernel = void (*)(const std::uint32_t*, std::uint32_t*);
+
+        // pack_block and unpack_block for a run time width, index 0 is
+        // width 1
+        template<std::size_t... B>
+        static constexpr std::array<block_kernel, sizeof...(B)> pack_table(std::index_sequence<B...>) {
+            return { &pack_block<B + 1>... };
+        }
+
+        template<std::size_t... B>
+        static constexpr std::array<block_kernel, sizeof...(B)> unpack_table(std::index_sequence<B...>) {
+            return { &unpack_block<B + 1>... };
+        }
+
+        static constexpr auto Pack = pack_table(std::make_index_sequence<32> {});
+        static constexpr auto Unpack = unpack_table(std::make_index_sequence<32> {});
+
+        // Codes one block of BlockSize words (already padded) onto out
+        static inline void
+        encode_block(const std::uint32_t* words, std::size_t count, std::uint32_t flip, std::vector<std::uint32_t>& out) {
+            std::uint32_t lo = ~0u, hi = 0, zmax = 0;
+            std::uint32_t deltas[BlockSize];
+
+            #pragma omp simd reduction(min:lo) reduction(max:hi)
+            for (std::size_t i = 0; i < BlockSize; i++) {
+                lo = std::min(lo, words[i] ^ flip);
+                hi = std::max(hi, words[i] ^ flip);
+            }
+
+            #pragma omp simd reduction(max:zmax)
+            for (std::size_t i = 0; i < BlockSize; i++) {
+                const std::uint32_t previous = i < Lanes ? words[0] : words[i - Lanes];
+                deltas[i] = zigzag(words[i] - previous);
+                zmax = std::max(zmax, deltas[i]);
+            }
+
+            const std::size_t for_bits = static_cast<std::size_t>(std::bit_width(hi - lo));
+            const std::size_t delta_bits = static_cast<std::size_t>(std::bit_width(zmax));
+
+            const block_mode mode = delta_bits < for_bits ? block_mode::delta : block_mode::frame_of_reference;
+            const std::size_t bits = std::min(for_bits, delta_bits);
+            const std::uint32_t base = mode == block_mode::delta ? words[0] : lo;
+
+            out.push_back(static_cast<std::uint32_t>(bits)
+                          | static_cast<std::uint32_t>(mode) << 8
+                          | static_cast<std::uint32_t>(count - 1) << 16);
+            out.push_back(base);
+
+            if (bits == 0) {
+                return;
+            }
+
+            if (mode == block_mode::frame_of_reference) {
+                #pragma omp simd
+                for (std::size_t i = 0; i < BlockSize; i++) {
+                    deltas[i] = (words[i] ^ flip) - lo;
+                }
+            }
+
+            const std::size_t at = out.size();
+            out.resize(at + bits * Lanes);
+            Pack[bits - 1](deltas, out.data() + at);
+        }
+
+        struct block_info {
+            std::size_t count;
+            std::size_t words;
+        };
+
+        // Decodes the block at the start of in into BlockSize words.
+        // The stream is not trusted: the header and the length of in
+        // are checked before anything is unpacked.
+        static inline std::expected<block_info, codec_error>
+        decode_block(std::span<const std::uint32_t> in, std::uint32_t flip, std::uint32_t* words) {
+            if (in.size() < HeaderWords) {
+                return std::unexpected(codec_error::truncated);
+            }
+
+            const std::size_t bits = in[0] & 0xff;
+            const auto mode = static_cast<block_mode>((in[0] >> 8) & 1);
+            const std::size_t count = ((in[0] >> 16) & 0xff) + 1;
+            const std::uint32_t base = in[1];
+
+            if (bits > 32 || (in[0] & 0xff00fe00u) != 0) {
+                return std::unexpected(codec_error::bad_header);
+            }
+
+            if (in.size() < HeaderWords + bits * Lanes) {
+                return std::unexpected(codec_error::truncated);
+            }
+
+            if (bits == 0) {
+                std::fill(words, words + BlockSize, 0u);
+            } else {
+                Unpack[bits - 1](in.data() + HeaderWords, words);
+            }
+
+            if (mode == block_mode::frame_of_reference) {
+                #pragma omp simd
+                for (std::size_t i = 0; i < BlockSize; i++) {
+                    words[i] = (words[i] + base) ^ flip;
+                }
+            } else {
+                #pragma omp simd
+                for (std::size_t l = 0; l < Lanes; l++) {
+                    words[l] = base + unzigzag(words[l]);
+                }
+
+                for (std::size_t r = 1; r < Rows; r++) {
+                    #pragma omp simd
+                    for (std::size_t l = 0; l < Lanes; l++) {
+                        words[r * Lanes + l] = words[(r - 1) * Lanes + l] + unzigzag(words[r * Lanes + l]);
+                    }
+                }
+            }
+
+            return block_info { count, HeaderWords + bits * Lanes };
+        }
+    }
+
+    // Upper bound on the number of words encoding n values can take
+    static constexpr std::size_t max_encoded_words(std::size_t n) {
+        using namespace detail::packing;
+        return (n + BlockSize - 1) / BlockSize * (detail::codec::HeaderWords + 32 * Lanes);
+    }
+
+    // Streaming encoder. Values are buffered until a block is full,
+    // finish() writes out whatever is left as a short block
+    template<is_fixed T>
+    requires (sizeof(typename T::storage_type) <= 4)
+    class block_encoder {
+        private:
+            std::vector<std::uint32_t>& out;
+            std::array<std::uint32_t, detail::packing::BlockSize> block;
+            std::size_t filled = 0;
+
+            void flush() {
+                // Repeating the last value keeps both codings as
+                // narrow as the real values need
+                std::fill(block.begin() + static_cast<std::ptrdiff_t>(filled), block.end(), block[filled - 1]);
+                detail::codec::encode_block(block.data(), filled, detail::codec::OrderFlip<T>, out);
+                filled = 0;
+            }
+
+        public:
+            // Appends encoded blocks to out
+            explicit block_encoder(std::vector<std::uint32_t>& out) : out(out) {}
+
+            void push(std::span<const T> values) {
+                for (std::size_t i = 0; i < values.size();) {
+                    const std::size_t m = std::min(values.size() - i, block.size() - filled);
+
+                    #pragma omp simd
+                    for (std::size_t j = 0; j < m; j++) {
+                        block[filled + j] = detail::packing::to_word(values[i + j]);
+                    }
+
+                    filled += m;
+                    i += m;
+
+                    if (filled == block.size()) {
+                        flush();
+                    }
+                }
+            }
+
+            void finish() {
+                if (filled > 0) {
+                    flush();
+                }
+            }
+    };
+
+    // Streaming decoder over an encoded buffer, one block at a time
+    template<is_fixed T>
+    requires (sizeof(typename T::storage_type) <= 4)
+    class block_decoder {
+        private:
+            std::span<const std::uint32_t> in;
+            std::array<std::uint32_t, detail::packing::BlockSize> block;
+
+        public:
+            explicit block_decoder(std::span<const std::uint32_t> in) : in(in) {}
+
+            bool done() const { return in.empty(); }
+
+            // Decodes the next block into out, which must have room for
+            // a whole block, and returns how many values it held. On a
+            // malformed block nothing is written and the decoder stays
+            // where it is.
+            std::expected<std::size_t, codec_error> next(T* out) {
+                const auto info = detail::codec::decode_block(in, detail::codec::OrderFlip<T>, block.data());
+                if (!info) {
+                    return std::unexpected(info.error());
+                }
+
+                in = in.subspan(info->words);
+
+                #pragma omp simd
+                for (std::size_t i = 0; i < info->count; i++) {
+                    out[i] = detail::packing::from_word<T, 32>(block[i]);
+                }
+
+                return info->count;
+            }
+    };
+
+    template<is_fixed T>
+    static inline std::vector<std::uint32_t>
+    encode(std::span<const T> values) {
+        std::vector<std::uint32_t> out;
+        out.reserve(max_encoded_words(values.size()));
+
+        block_encoder<T> encoder(out);
+        encoder.push(values);
+        encoder.finish();
+
+        return out;
+    }
+
+    template<is_fixed T>
+    static inline std::expected<std::vector<T>, codec_error>
+    decode(std::span<const std::uint32_t> in) {
+        std::vector<T> out;
+        block_decoder<T> decoder(in);
+
+        while (!decoder.done()) {
+            const std::size_t at = out.size();
+            out.resize(at + detail::packing::BlockSize);
+
+            const auto count = decoder.next(out.data() + at);
+            if (!count) {
+                return std::unexpected(count.error());
+            }
+
+            out.resize(at + *count);
+        }
+
+        return out;
+    }
+}
@@ -0,0 +1,331 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <fixp.hpp>
+#include <hints.hpp>
+#include <type_traits>
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace fixp {
+    // Interleaved (re, im) pair, so arrays of complex<T> share their
+    // layout with the I/Q buffers handed out by drivers and with the
+    // fixp::dsp::fft data.
+    template<is_fixed T>
+    struct complex {
+        using value_type = T;
+
+        T re;
+        T im;
+    };
+
+    template<is_fixed T>
+    static constexpr complex<T> operator+(const complex<T>& a, const complex<T>& b) {
+        return { a.re + b.re, a.im + b.im };
+    }
+
+    template<is_fixed T>
+    static constexpr complex<T> operator-(const complex<T>& a, const complex<T>& b) {
+        return { a.re - b.re, a.im - b.im };
+    }
+
+    template<is_fixed T>
+    static constexpr complex<T> operator-(const complex<T>& a) {
+        return { -a.re, -a.im };
+    }
+
+    // Both terms of each component are formed in the intermediate
+    // type and shifted once, truncating like fixed's operator*
+    template<is_fixed T>
+    static constexpr complex<T> operator*(const complex<T>& a, const complex<T>& b) {
+        using Intermediate = typename T::intermediate_type;
+        using Storage = typename T::storage_type;
+
+        const Intermediate re = static_cast<Intermediate>(a.re.raw) * b.re.raw - static_cast<Intermediate>(a.im.raw) * b.im.raw;
+        const Intermediate im = static_cast<Intermediate>(a.re.raw) * b.im.raw + static_cast<Intermediate>(a.im.raw) * b.re.raw;
+
+        return {
+            T::from_raw(static_cast<Storage>(re >> T::FracBits)),
+            T::from_raw(static_cast<Storage>(im >> T::FracBits)),
+        };
+    }
+
+    template<is_fixed T>
+    static constexpr complex<T>& operator+=(complex<T>& a, const complex<T>& b) {
+        a = a + b;
+        return a;
+    }
+
+    template<is_fixed T>
+    static constexpr complex<T>& operator-=(complex<T>& a, const complex<T>& b) {
+        a = a - b;
+        return a;
+    }
+
+    template<is_fixed T>
+    static constexpr complex<T>& operator*=(complex<T>& a, const complex<T>& b) {
+        a = a * b;
+        return a;
+    }
+
+    template<is_fixed T>
+    static constexpr bool operator==(const complex<T>& a, const complex<T>& b) {
+        return a.re == b.re && a.im == b.im;
+    }
+
+    template<is_fixed T>
+    static constexpr complex<T> conj(const complex<T>& a) {
+        return { a.re, -a.im };
+    }
+
+    // Squared magnitude, re^2 + im^2 with a single shift
+    template<is_fixed T>
+    static constexpr T norm(const complex<T>& a) {
+        using Intermediate = typename T::intermediate_type;
+        using Storage = typename T::storage_type;
+
+        const Intermediate n = static_cast<Intermediate>(a.re.raw) * a.re.raw + static_cast<Intermediate>(a.im.raw) * a.im.raw;
+        return T::from_raw(static_cast<Storage>(n >> T::FracBits));
+    }
+
+    namespace detail::complex_kernels {
+        // Complex multiply of n interleaved pairs, optionally
+        // conjugating b. The NEON paths deinterleave eight (or four)
+        // pairs per load and reinterleave on the store.
+        template<bool Conjugate, is_fixed T>
+        FIXP_ALWAYS_INLINE static inline void
+        mul(const complex<T>* a, const complex<T>* b, complex<T>* out, std::size_t n) {
+            std::size_t i = 0;
+
+            #ifdef __ARM_NEON
+            using Intermediate = typename T::intermediate_type;
+            using Storage = typename T::storage_type;
+
+            constexpr int F = T::FracBits;
+
+            if constexpr (std::same_as<Storage, std::int16_t> && std::same_as<Intermediate, std::int32_t> && F > 0) {
+                for (; i + 8 <= n; i += 8) {
+                    const int16x8x2_t va = vld2q_s16(&a[i].re.raw);
+                    int16x8x2_t vb = vld2q_s16(&b[i].re.raw);
+
+                    if constexpr (Conjugate) {
+                        vb.val[1] = vnegq_s16(vb.val[1]);
+                    }
+
+                    const int32x4_t re_lo = vmlsl_s16(vmull_s16(vget_low_s16(va.val[0]), vget_low_s16(vb.val[0])), vget_low_s16(va.val[1]), vget_low_s16(vb.val[1]));
+                    const int32x4_t re_hi = vmlsl_high_s16(vmull_high_s16(va.val[0], vb.val[0]), va.val[1], vb.val[1]);
+                    const int32x4_t im_lo = vmlal_s16(vmull_s16(vget_low_s16(va.val[0]), vget_low_s16(vb.val[1])), vget_low_s16(va.val[1]), vget_low_s16(vb.val[0]));
+                    const int32x4_t im_hi = vmlal_high_s16(vmull_high_s16(va.val[0], vb.val[1]), va.val[1], vb.val[0]);
+
+                    int16x8x2_t vresult;
+                    vresult.val[0] = vcombine_s16(vshrn_n_s32(re_lo, F), vshrn_n_s32(re_hi, F));
+                    vresult.val[1] = vcombine_s16(vshrn_n_s32(im_lo, F), vshrn_n_s32(im_hi, F));
+
+                    vst2q_s16(&out[i].re.raw, vresult);
+                }
+            } else if constexpr (std::same_as<Storage, std::int32_t> && std::same_as<Intermediate, std::int64_t> && F > 0) {
+                for (; i + 4 <= n; i += 4) {
+                    const int32x4x2_t va = vld2q_s32(&a[i].re.raw);
+                    int32x4x2_t vb = vld2q_s32(&b[i].re.raw);
+
+                    if constexpr (Conjugate) {
+                        vb.val[1] = vnegq_s32(vb.val[1]);
+                    }
+
+                    const int64x2_t re_lo = vmlsl_s32(vmull_s32(vget_low_s32(va.val[0]), vget_low_s32(vb.val[0])), vget_low_s32(va.val[1]), vget_low_s32(vb.val[1]));
+                    const int64x2_t re_hi = vmlsl_high_s32(vmull_high_s32(va.val[0], vb.val[0]), va.val[1], vb.val[1]);
+                    const int64x2_t im_lo = vmlal_s32(vmull_s32(vget_low_s32(va.val[0]), vget_low_s32(vb.val[1])), vget_low_s32(va.val[1]), vget_low_s32(vb.val[0]));
+                    const int64x2_t im_hi = vmlal_high_s32(vmull_high_s32(va.val[0], vb.val[1]), va.val[1], vb.val[0]);
+
+                    int32x4x2_t vresult;
+                    vresult.val[0] = vcombine_s32(vshrn_n_s64(re_lo, F), vshrn_n_s64(re_hi, F));
+                    vresult.val[1] = vcombine_s32(vshrn_n_s64(im_lo, F), vshrn_n_s64(im_hi, F));
+
+                    vst2q_s32(&out[i].re.raw, vresult);
+                }
+            }
+            #endif
+
+            #pragma omp simd
+            for (std::size_t j = i; j < n; j++) {
+                out[j] = a[j] * (Conjugate ? conj(b[j]) : b[j]);
+            }
+        }
+    }
+
+    // out[i] = a[i] * b[i]
+    template<is_fixed T>
+    static inline void
+    mul(const complex<T>* a, const complex<T>* b, complex<T>* out, std::size_t n) {
+        detail::complex_kernels::mul<false>(a, b, out, n);
+    }
+
+    // out[i] = a[i] * conj(b[i])
+    template<is_fixed T>
+    static inline void
+    mul_conj(const complex<T>* a, const complex<T>* b, complex<T>* out, std::size_t n) {
+        detail::complex_kernels::mul<true>(a, b, out, n);
+    }
+
+    // out[i] = |a[i]|^2
+    template<is_fixed T>
+    static inline void
+    norm(const complex<T>* a, T* out, std::size_t n) {
+        std::size_t i = 0;
+
+        #ifdef __ARM_NEON
+        using Intermediate = typename T::intermediate_type;
+        using Storage = typename T::storage_type;
+
+        constexpr int F = T::FracBits;
+
+        if constexpr (std::same_as<Storage, std::int16_t> && std::same_as<Intermediate, std::int32_t> && F > 0) {
+            for (; i + 8 <= n; i += 8) {
+                const int16x8x2_t va = vld2q_s16(&a[i].re.raw);
+
+                const int32x4_t lo = vmlal_s16(vmull_s16(vget_low_s16(va.val[0]), vget_low_s16(va.val[0])), vget_low_s16(va.val[1]), vget_low_s16(va.val[1]));
+                const int32x4_t hi = vmlal_high_s16(vmull_high_s16(va.val[0], va.val[0]), va.val[1], va.val[1]);
+
+                vst1q_s16(&out[i].raw, vcombine_s16(vshrn_n_s32(lo, F), vshrn_n_s32(hi, F)));
+            }
+        } else if constexpr (std::same_as<Storage, std::int32_t> && std::same_as<Intermediate, std::int64_t> && F > 0) {
+            for (; i + 4 <= n; i += 4) {
+                const int32x4x2_t va = vld2q_s32(&a[i].re.raw);
+
+                const int64x2_t lo = vmlal_s32(vmull_s32(vget_low_s32(va.val[0]), vget_low_s32(va.val[0])), vget_low_s32(va.val[1]), vget_low_s32(va.val[1]));
+                const int64x2_t hi = vmlal_high_s32(vmull_high_s32(va.val[0], va.val[0]), va.val[1], va.val[1]);
+
+                vst1q_s32(&out[i].raw, vcombine_s32(vshrn_n_s64(lo, F), vshrn_n_s64(hi, F)));
+            }
+        }
+        #endif
+
+        #pragma omp simd
+        for (std::size_t j = i; j < n; j++) {
+            out[j] = norm(a[j]);
+        }
+    }
+
+    // sum(a[i] * conj(b[i])), i.e. the correlation of a and b at lag 0.
+    // Products are accumulated at full precision and shifted once; the
+    // default accumulator (accumulator_t) has 64 bits even for Q15.
+    template<is_fixed T, is_signed_integer Accumulator = accumulator_t<T>>
+    static inline complex<T>
+    dot_conj(const complex<T>* a, const complex<T>* b, std::size_t n) {
+        using Storage = typename T::storage_type;
+
+        Accumulator re = 0;
+        Accumulator im = 0;
+        std::size_t i = 0;
+
+        #ifdef __ARM_NEON
+        if constexpr (std::same_as<Storage, std::int16_t> && std::same_as<Accumulator, std::int32_t>) {
+            int32x4_t vre = vdupq_n_s32(0);
+            int32x4_t vim = vdupq_n_s32(0);
+
+            for (; i + 8 <= n; i += 8) {
+                const int16x8x2_t va = vld2q_s16(&a[i].re.raw);
+                const int16x8x2_t vb = vld2q_s16(&b[i].re.raw);
+
+                // re += ar * br + ai * bi, im += ai * br - ar * bi
+                vre = vmlal_s16(vre, vget_low_s16(va.val[0]), vget_low_s16(vb.val[0]));
+                vre = vmlal_high_s16(vre, va.val[0], vb.val[0]);
+                vre = vmlal_s16(vre, vget_low_s16(va.val[1]), vget_low_s16(vb.val[1]));
+                vre = vmlal_high_s16(vre, va.val[1], vb.val[1]);
+                vim = vmlal_s16(vim, vget_low_s16(va.val[1]), vget_low_s16(vb.val[0]));
+                vim = vmlal_high_s16(vim, va.val[1], vb.val[0]);
+                vim = vmlsl_s16(vim, vget_low_s16(va.val[0]), vget_low_s16(vb.val[1]));
+                vim = vmlsl_high_s16(vim, va.val[0], vb.val[1]);
+            }
+
+            re = vaddvq_s32(vre);
+            im = vaddvq_s32(vim);
+        } else if constexpr (std::same_as<Storage, std::int16_t> && std::same_as<Accumulator, std::int64_t>) {
+            // Every product is widened into 64 bit lanes on its own
+            // (vpadal), since even the sum of two can overflow int32.
+            // The subtracted products get an accumulator of their own.
+            int64x2_t vre = vdupq_n_s64(0);
+            int64x2_t vim = vdupq_n_s64(0);
+            int64x2_t vim_sub = vdupq_n_s64(0);
+
+            for (; i + 8 <= n; i += 8) {
+                const int16x8x2_t va = vld2q_s16(&a[i].re.raw);
+                const int16x8x2_t vb = vld2q_s16(&b[i].re.raw);
+
+                vre = vpadalq_s32(vre, vmull_s16(vget_low_s16(va.val[0]), vget_low_s16(vb.val[0])));
+                vre = vpadalq_s32(vre, vmull_high_s16(va.val[0], vb.val[0]));
+                vre = vpadalq_s32(vre, vmull_s16(vget_low_s16(va.val[1]), vget_low_s16(vb.val[1])));
+                vre = vpadalq_s32(vre, vmull_high_s16(va.val[1], vb.val[1]));
+                vim = vpadalq_s32(vim, vmull_s16(vget_low_s16(va.val[1]), vget_low_s16(vb.val[0])));
+                vim = vpadalq_s32(vim, vmull_high_s16(va.val[1], vb.val[0]));
+                vim_sub = vpadalq_s32(vim_sub, vmull_s16(vget_low_s16(va.val[0]), vget_low_s16(vb.val[1])));
+                vim_sub = vpadalq_s32(vim_sub, vmull_high_s16(va.val[0], vb.val[1]));
+            }
+
+            re = vaddvq_s64(vre);
+            im = vaddvq_s64(vsubq_s64(vim, vim_sub));
+        } else if constexpr (std::same_as<Storage, std::int32_t> && std::same_as<Accumulator, std::int64_t>) {
+            int64x2_t vre = vdupq_n_s64(0);
+            int64x2_t vim = vdupq_n_s64(0);
+
+            for (; i + 4 <= n; i += 4) {
+                const int32x4x2_t va = vld2q_s32(&a[i].re.raw);
+                const int32x4x2_t vb = vld2q_s32(&b[i].re.raw);
+
+                vre = vmlal_s32(vre, vget_low_s32(va.val[0]), vget_low_s32(vb.val[0]));
+                vre = vmlal_high_s32(vre, va.val[0], vb.val[0]);
+                vre = vmlal_s32(vre, vget_low_s32(va.val[1]), vget_low_s32(vb.val[1]));
+                vre = vmlal_high_s32(vre, va.val[1], vb.val[1]);
+                vim = vmlal_s32(vim, vget_low_s32(va.val[1]), vget_low_s32(vb.val[0]));
+                vim = vmlal_high_s32(vim, va.val[1], vb.val[0]);
+                vim = vmlsl_s32(vim, vget_low_s32(va.val[0]), vget_low_s32(vb.val[1]));
+                vim = vmlsl_high_s32(vim, va.val[0], vb.val[1]);
+            }
+
+            re = vaddvq_s64(vre);
+            im = vaddvq_s64(vim);
+        }
+        #endif
+
+        #pragma omp simd reduction(+:re, im)
+        for (std::size_t j = i; j < n; j++) {
+            const Accumulator ar = a[j].re.raw;
+            const Accumulator ai = a[j].im.raw;
+            const Accumulator br = b[j].re.raw;
+            const Accumulator bi = b[j].im.raw;
+
+            re += ar * br + ai * bi;
+            im += ai * br - ar * bi;
+        }
+
+        return {
+            T::from_raw(static_cast<Storage>(re >> T::FracBits)),
+            T::from_raw(static_cast<Storage>(im >> T::FracBits)),
+        };
+    }
+}
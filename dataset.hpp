@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <fstream>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <fixp.hpp>
+#include <view.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// A flat file of fixed values: a 64 byte header recording the format,
+// then the raw values. Opening one maps the file and hands out the
+// payload as a span of fixed values in place, so it costs the same
+// whatever the size of the file, and pages are read as they are
+// touched. POSIX only (mmap).
+namespace fixp {
+    // Header fields are little endian. The payload is in the byte
+    // order given by `endianness`, and starts at payload_offset, a
+    // multiple of 64
+    struct dataset_header {
+        char magic[4];
+        std::uint16_t version;
+        std::uint8_t frac_bits;
+        std::uint8_t storage_bits;
+        std::uint8_t is_signed;
+        std::uint8_t endianness;
+        std::uint8_t reserved[6];
+        std::uint64_t count;
+        std::uint64_t payload_offset;
+        std::uint8_t padding[32];
+    };
+
+    static_assert(sizeof(dataset_header) == 64 && std::is_trivially_copyable_v<dataset_header>);
+
+    enum class dataset_error {
+        // The file could not be opened, stat'd or mapped, see errno
+        io,
+        // Not a dataset, or a version we do not know
+        bad_header,
+        // A dataset of some other fixed format
+        format_mismatch,
+        // Payload byte order differs from the host, so it cannot be
+        // used in place
+        byte_order,
+        // The header promises more values than the file holds
+        truncated,
+    };
+
+    namespace detail::dataset {
+        static constexpr char Magic[4] = { 'F', 'X', 'P', 'D' };
+        static constexpr std::uint16_t Version = 1;
+        static constexpr std::uint64_t PayloadAlignment = 64;
+
+        static constexpr std::uint8_t LittleEndian = 0;
+        static constexpr std::uint8_t BigEndian = 1;
+
+        static constexpr std::uint8_t NativeEndian = std::endian::native == std::endian::little ? LittleEndian : BigEndian;
+
+        // Between host and little endian, either way
+        template<std::unsigned_integral U>
+        static constexpr U little(U v) {
+            if constexpr (std::endian::native == std::endian::big) {
+                return std::byteswap(v);
+            } else {
+                return v;
+            }
+        }
+
+        template<is_fixed T>
+        static constexpr dataset_header header_for(std::uint64_t count) {
+            dataset_header h {};
+            std::memcpy(h.magic, Magic, sizeof(Magic));
+            h.version = little(Version);
+            h.frac_bits = static_cast<std::uint8_t>(T::FracBits);
+            h.storage_bits = static_cast<std::uint8_t>(T::TotalBits);
+            h.is_signed = is_signed_integer<typename T::storage_type> ? 1 : 0;
+            h.endianness = NativeEndian;
+            h.count = little(count);
+            h.payload_offset = little(std::uint64_t { sizeof(dataset_header) });
+            return h;
+        }
+    }
+
+    // Writes values as a dataset in the host's byte order. Returns
+    // false if the file could not be written
+    template<is_fixed T>
+    static bool
+    write_dataset(const char* path, std::span<const T> values) {
+        static_assert(detail::has_storage_layout<T>());
+
+        const dataset_header header = detail::dataset::header_for<T>(values.size());
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+
+        return static_cast<bool>(file.flush());
+    }
+
+    // A read-only mapping of a dataset of T. Move only, unmapped on
+    // destruction
+    template<is_fixed T>
+    class mapped_dataset {
+        private:
+            void* mapping = nullptr;
+            std::size_t mapping_size = 0;
+            std::span<const T> payload;
+
+            mapped_dataset(void* mapping, std::size_t size, std::span<const T> payload)
+                : mapping(mapping), mapping_size(size), payload(payload) {}
+
+            void unmap() {
+                if (mapping) {
+                    ::munmap(mapping, mapping_size);
+                    mapping = nullptr;
+                }
+            }
+
+        public:
+            mapped_dataset(mapped_dataset&& other) noexcept
+                : mapping(std::exchange(other.mapping, nullptr)),
+                  mapping_size(std::exchange(other.mapping_size, 0)),
+                  payload(std::exchange(other.payload, {})) {}
+
+            mapped_dataset& operator=(mapped_dataset&& other) noexcept {
+                if (this != &other) {
+                    unmap();
+                    mapping = std::exchange(other.mapping, nullptr);
+                    mapping_size = std::exchange(other.mapping_size, 0);
+                    payload = std::exchange(other.payload, {});
+                }
+
+                return *this;
+            }
+
+            ~mapped_dataset() { unmap(); }
+
+            // Validates the header against T and maps the file. The
+            // payload is not read
+            static std::expected<mapped_dataset, dataset_error> open(const char* path) {
+                namespace ds = detail::dataset;
+                static_assert(detail::has_storage_layout<T>());
+
+                const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    return std::unexpected(dataset_error::io);
+                }
+
+                struct stat st;
+                if (::fstat(fd, &st) != 0) {
+                    ::close(fd);
+                    return std::unexpected(dataset_error::io);
+                }
+
+                const std::size_t size = static_cast<std::size_t>(st.st_size);
+                if (size < sizeof(dataset_header)) {
+                    ::close(fd);
+                    return std::unexpected(dataset_error::bad_header);
+                }
+
+                void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+                ::close(fd);
+
+                if (mapping == MAP_FAILED) {
+                    return std::unexpected(dataset_error::io);
+                }
+
+                mapped_dataset dataset(mapping, size, {});
+
+                dataset_header header;
+                std::memcpy(&header, mapping, sizeof(header));
+
+                const std::uint64_t count = ds::little(header.count);
+                const std::uint64_t offset = ds::little(header.payload_offset);
+
+                if (std::memcmp(header.magic, ds::Magic, sizeof(ds::Magic)) != 0 || ds::little(header.version) != ds::Version
+                    || offset < sizeof(dataset_header) || offset % ds::PayloadAlignment != 0) {
+                    return std::unexpected(dataset_error::bad_header);
+                }
+
+                if (header.frac_bits != T::FracBits || header.storage_bits != T::TotalBits
+                    || header.is_signed != (is_signed_integer<typename T::storage_type> ? 1 : 0)) {
+                    return std::unexpected(dataset_error::format_mismatch);
+                }
+
+                if (header.endianness != ds::NativeEndian) {
+                    return std::unexpected(dataset_error::byte_order);
+                }
+
+                if (offset > size || count > (size - offset) / sizeof(T)) {
+                    return std::unexpected(dataset_error::truncated);
+                }
+
+                const auto* bytes = static_cast<const std::byte*>(mapping) + offset;
+                dataset.payload = span_view<T>(reinterpret_cast<const typename T::storage_type*>(bytes),
+                                               static_cast<std::size_t>(count));
+
+                return dataset;
+            }
+
+            std::span<const T> values() const { return payload; }
+            std::size_t size() const { return payload.size(); }
+
+            const T* begin() const { return payload.data(); }
+            const T* end() const { return payload.data() + payload.size(); }
+            const T& operator[](std::size_t i) const { return payload[i]; }
+    };
+}
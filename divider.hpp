@@ -0,0 +1,397 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <fixp.hpp>
+#include <limits>
+#include <hints.hpp>
+#include <type_traits>
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace fixp {
+    enum class division_accuracy {
+        // Bit-identical to operator/
+        exact,
+        // Either the exact quotient or the next one toward zero, one
+        // compare and multiply cheaper
+        faithful,
+    };
+
+    namespace detail::divide {
+        // High half of the full product a * b
+        template<is_unsigned_integer U>
+        FIXP_ALWAYS_INLINE static constexpr U
+        mulhi(U a, U b) {
+            if constexpr (sizeof(U) <= sizeof(std::uint32_t)) {
+                return static_cast<U>((static_cast<std::uint64_t>(a) * b) >> (sizeof(U) * 8));
+            } else if constexpr (sizeof(U) == sizeof(std::uint64_t)) {
+                return static_cast<U>((static_cast<unsigned __int128>(a) * b) >> 64);
+            } else {
+                // Schoolbook on 64 bit halves
+                const unsigned __int128 a0 = static_cast<std::uint64_t>(a), a1 = a >> 64;
+                const unsigned __int128 b0 = static_cast<std::uint64_t>(b), b1 = b >> 64;
+
+                const unsigned __int128 p01 = a0 * b1;
+                const unsigned __int128 p10 = a1 * b0;
+                const unsigned __int128 mid = ((a0 * b0) >> 64) + static_cast<std::uint64_t>(p01) + static_cast<std::uint64_t>(p10);
+
+                return a1 * b1 + (p01 >> 64) + (p10 >> 64) + (mid >> 64);
+            }
+        }
+
+        // The type operator/ shifts and divides in: the intermediate
+        // type after integer promotion, so int for 8 and 16 bit ones
+        template<is_fixed T>
+        using numerator_t = std::common_type_t<int, typename T::intermediate_type>;
+
+        // Unsigned type wide enough for the magnitude of a.raw <<
+        // FracBits as operator/ computes it: the exact value when it
+        // fits numerator_t, otherwise the value wrapped to numerator_t
+        template<is_fixed T>
+        using magnitude_t = uint_of_bits_t<std::min<std::size_t>(T::TotalBits + T::FracBits,
+                                                                 sizeof(numerator_t<T>) * 8)>;
+
+        static constexpr std::size_t SeedBits = 8;
+
+        // 1 / x in Q1.15 for x in [0.5, 1), indexed by the SeedBits
+        // bits below the leading one. Each entry is taken at the top
+        // of its interval, so the seed never overestimates.
+        static constexpr auto ReciprocalSeeds = ([]() constexpr {
+            constexpr std::size_t Size = std::size_t { 1 } << SeedBits;
+            std::array<std::uint32_t, Size> table = { };
+
+            for (std::size_t i = 0; i < Size; i++) {
+                const double x = 0.5 + static_cast<double>(i + 1) / static_cast<double>(2 * Size);
+                table[i] = static_cast<std::uint32_t>(32768.0 / x);
+            }
+
+            return table;
+        })();
+
+        // Each iteration doubles the correct bits of the seed
+        template<const std::size_t Bits>
+        static constexpr std::size_t NewtonIterations = ([]() constexpr {
+            std::size_t iterations = 0;
+
+            for (std::size_t bits = SeedBits; bits < Bits; bits *= 2) {
+                iterations++;
+            }
+
+            return iterations;
+        })();
+
+        // floor(n / d), or one less with division_accuracy::faithful.
+        // FullWidth is set when n may use the top bit of U, which
+        // doubles the error of the estimate.
+        //
+        // d is normalised to x = d << s in [2^(N-1), 2^N), a seed for
+        // y = 2^(2N-1) / x comes from the table and is refined by
+        // Newton-Raphson, y' = y + y * (1 - x * y). The iteration
+        // approaches 1 / x from below, so the estimate n * y / 2^(2N-1-s)
+        // is never too large and one compare fixes it up.
+        template<division_accuracy Accuracy, const bool FullWidth, is_unsigned_integer U>
+        FIXP_ALWAYS_INLINE static constexpr U
+        newton_quotient(U n, U d) {
+            constexpr std::size_t Bits = sizeof(U) * 8;
+
+            using Wide = uint_of_bits_t<2 * Bits>;
+
+            // Leading zeros from the exponent of float(d), which
+            // vectorises where a vector clz does not exist (AVX2).
+            // Rounding can only make the exponent one too large, in
+            // which case the top bit of x is still clear.
+            const int exponent = static_cast<int>(std::bit_cast<std::uint32_t>(static_cast<float>(d)) >> 23) - 127;
+            const U fix = static_cast<U>(~(d << (Bits - 1 - exponent)) >> (Bits - 1));
+            const U s = static_cast<U>(Bits - 1 - exponent) + fix;
+            const U x = static_cast<U>(d << s);
+
+            U y = static_cast<U>(ReciprocalSeeds[(x >> (Bits - 1 - SeedBits)) & ((1 << SeedBits) - 1)]) << (Bits - 16);
+
+            for (std::size_t i = 0; i < NewtonIterations<Bits>; i++) {
+                // y never overestimates, so x * y <= 2^(2N-1) and
+                // e >= 0: everything stays unsigned N x N -> 2N bit
+                const U e = static_cast<U>((U { 1 } << (Bits - 1)) - static_cast<U>((static_cast<Wide>(x) * y) >> Bits));
+
+                // Truncating x * y overestimates e, which can push the
+                // update up to two units past 1 / x; stepping back
+                // keeps the invariant
+                y = static_cast<U>(y + static_cast<U>((static_cast<Wide>(y) * e) >> (Bits - 1)) - 2);
+            }
+
+            U q = static_cast<U>(static_cast<U>((static_cast<Wide>(n) * y) >> Bits) >> (Bits - 1 - s));
+
+            // The estimate is at most 2 (4 with FullWidth) too small
+            constexpr std::size_t Corrections = (Accuracy == division_accuracy::exact ? 1 : 0) + (FullWidth ? 3 : 1);
+
+            if constexpr (Corrections > 0) {
+                // q never overshoots, so n - q * d cannot wrap
+                U r = static_cast<U>(n - q * d);
+
+                for (std::size_t i = 0; i < Corrections; i++) {
+                    const bool low = r >= d;
+
+                    q += low ? 1 : 0;
+                    r -= low ? d : 0;
+                }
+            }
+
+            return q;
+        }
+
+        // n and d as operator/ sees them, Newton-Raphson in at least
+        // 32 bit lanes
+        template<division_accuracy Accuracy, is_fixed T>
+        FIXP_ALWAYS_INLINE static constexpr T
+        newton_divide(numerator_t<T> n, typename T::storage_type d) {
+            using Storage = typename T::storage_type;
+            using U = std::conditional_t<(sizeof(magnitude_t<T>) < sizeof(std::uint32_t)), std::uint32_t, magnitude_t<T>>;
+
+            if constexpr (is_signed_integer<numerator_t<T>>) {
+                const bool negative = (n < 0) != (d < 0);
+                const U abs_n = n < 0 ? static_cast<U>(U { 0 } - static_cast<U>(n)) : static_cast<U>(n);
+                const U abs_d = d < 0 ? static_cast<U>(U { 0 } - static_cast<U>(d)) : static_cast<U>(d);
+
+                const U q = newton_quotient<Accuracy, false>(abs_n, abs_d);
+                return T::from_raw(static_cast<Storage>(negative ? U { 0 } - q : q));
+            } else {
+                constexpr bool FullWidth = T::TotalBits + T::FracBits >= sizeof(U) * 8;
+                return T::from_raw(static_cast<Storage>(newton_quotient<Accuracy, FullWidth>(static_cast<U>(n), static_cast<U>(d))));
+            }
+        }
+    }
+
+    // Division by a divisor that is only known at run time but reused
+    // many times. The constructor does the one real division and
+    // stores a reciprocal, after which every quotient costs a high
+    // multiply, an add and two shifts. Quotients are bit-identical to
+    // operator/, including its truncation toward zero.
+    //
+    // This is the round-up method of Granlund and Montgomery (as in
+    // libdivide): for an N bit numerator n and l = ceil(log2(d)),
+    //
+    //   m = floor(2^N * (2^l - d) / d) + 1
+    //   t = (m * n) >> N
+    //   n / d = (t + ((n - t) >> 1)) >> (l - 1)
+    //
+    // Signs are stripped before and restored after, like truncating
+    // division does.
+    template<is_fixed T>
+    class divider final {
+        private:
+            using Storage = typename T::storage_type;
+            using Intermediate = typename T::intermediate_type;
+            using Numerator = detail::divide::numerator_t<T>;
+            using Magnitude = detail::divide::magnitude_t<T>;
+
+            static constexpr std::size_t Bits = sizeof(Magnitude) * 8;
+            // Promotion to int makes operator/ divide signed even for
+            // unsigned storage, where a.raw << FracBits can go negative
+            static constexpr bool Signed = is_signed_integer<Numerator>;
+
+            T d;
+            Magnitude magic;
+            // shift_a is 0 only for |d| == 1, where the formula
+            // degenerates to t = 0, q = n
+            std::uint8_t shift_a;
+            std::uint8_t shift_b;
+
+            FIXP_ALWAYS_INLINE constexpr Magnitude
+            quotient(Magnitude n) const {
+                const Magnitude t = detail::divide::mulhi(magic, n);
+                return (t + ((n - t) >> shift_a)) >> shift_b;
+            }
+
+        public:
+            // divisor must not be zero
+            explicit constexpr divider(const T& divisor) : d(divisor) {
+                const Magnitude abs_d = Signed && divisor.raw < 0
+                    ? static_cast<Magnitude>(Magnitude { 0 } - static_cast<Magnitude>(divisor.raw))
+                    : static_cast<Magnitude>(divisor.raw);
+
+                // ceil(log2(d)), std::bit_width has no unsigned __int128
+                std::size_t l = 0;
+                while (l < Bits && (Magnitude { 1 } << l) < abs_d) {
+                    l++;
+                }
+
+                // Long division of (2^l - d) * 2^N by d. 2^l - d < d,
+                // so the quotient fits N bits; 2^l itself may not,
+                // but the difference is right modulo 2^N.
+                const Magnitude pow2_l = l < Bits ? Magnitude { 1 } << l : Magnitude { 0 };
+                Magnitude r = pow2_l - abs_d;
+                Magnitude q = 0;
+
+                for (std::size_t i = 0; i < Bits; i++) {
+                    const bool carry = r >> (Bits - 1);
+
+                    r <<= 1;
+                    q <<= 1;
+
+                    if (carry || r >= abs_d) {
+                        r -= abs_d;
+                        q |= 1;
+                    }
+                }
+
+                magic = q + 1;
+                shift_a = static_cast<std::uint8_t>(std::min<std::size_t>(l, 1));
+                shift_b = static_cast<std::uint8_t>(l - shift_a);
+            }
+
+            constexpr T divisor() const {
+                return d;
+            }
+
+            // a / divisor()
+            constexpr T divide(const T& a) const {
+                const Numerator n = static_cast<Numerator>(static_cast<Numerator>(a.raw) << T::FracBits);
+
+                if constexpr (Signed) {
+                    const bool negative = (n < 0) != (d.raw < 0);
+                    const Magnitude abs_n = n < 0
+                        ? static_cast<Magnitude>(Magnitude { 0 } - static_cast<Magnitude>(n))
+                        : static_cast<Magnitude>(n);
+
+                    const Magnitude q = quotient(abs_n);
+                    return T::from_raw(static_cast<Storage>(negative ? Magnitude { 0 } - q : q));
+                } else {
+                    return T::from_raw(static_cast<Storage>(quotient(static_cast<Magnitude>(n))));
+                }
+            }
+
+            // out[i] = in[i] / divisor()
+            void divide(const T* in, T* out, std::size_t n) const {
+                std::size_t i = 0;
+
+                #ifdef __ARM_NEON
+                if constexpr (std::same_as<Magnitude, std::uint32_t> && std::same_as<Intermediate, std::int32_t>) {
+                    const uint32x2_t m = vdup_n_u32(magic);
+                    const int32x4_t neg_shift_a = vdupq_n_s32(-static_cast<int>(shift_a));
+                    const int32x4_t neg_shift_b = vdupq_n_s32(-static_cast<int>(shift_b));
+                    const int32x4_t d_sign = vdupq_n_s32(d.raw < 0 ? -1 : 0);
+
+                    const auto divide_s32 = [&](int32x4_t v) {
+                        v = vshlq_n_s32(v, T::FracBits);
+
+                        // All ones where the quotient is negative
+                        const int32x4_t sign = veorq_s32(vshrq_n_s32(v, 31), d_sign);
+                        const uint32x4_t abs_n = vreinterpretq_u32_s32(vabsq_s32(v));
+
+                        const uint32x4_t t = vcombine_u32(vshrn_n_u64(vmull_u32(vget_low_u32(abs_n), m), 32),
+                                                          vshrn_n_u64(vmull_high_u32(abs_n, vcombine_u32(m, m)), 32));
+                        const uint32x4_t q = vshlq_u32(vaddq_u32(t, vshlq_u32(vsubq_u32(abs_n, t), neg_shift_a)), neg_shift_b);
+
+                        return vsubq_s32(veorq_s32(vreinterpretq_s32_u32(q), sign), sign);
+                    };
+
+                    if constexpr (std::same_as<Storage, std::int16_t>) {
+                        for (; i + 8 <= n; i += 8) {
+                            const int16x8_t v = vld1q_s16(&in[i].raw);
+                            const int32x4_t lo = divide_s32(vmovl_s16(vget_low_s16(v)));
+                            const int32x4_t hi = divide_s32(vmovl_high_s16(v));
+
+                            vst1q_s16(&out[i].raw, vcombine_s16(vmovn_s32(lo), vmovn_s32(hi)));
+                        }
+                    } else if constexpr (std::same_as<Storage, std::int32_t>) {
+                        for (; i + 4 <= n; i += 4) {
+                            vst1q_s32(&out[i].raw, divide_s32(vld1q_s32(&in[i].raw)));
+                        }
+                    }
+                }
+                #endif
+
+                #pragma omp simd
+                for (std::size_t j = i; j < n; j++) {
+                    out[j] = divide(in[j]);
+                }
+            }
+    };
+
+    template<is_fixed T>
+    static constexpr T operator/(const T& a, const divider<T>& d) {
+        return d.divide(a);
+    }
+
+    template<is_fixed T>
+    static constexpr T& operator/=(T& a, const divider<T>& d) {
+        a = d.divide(a);
+        return a;
+    }
+
+    // out[i] = a[i] / b[i] for arrays where every divisor differs.
+    // Instead of one hardware division per element, a table seeded
+    // Newton-Raphson reciprocal is computed in every SIMD lane and
+    // multiplied in, see detail::divide::newton_quotient. This pays
+    // off where the vector unit has no integer divide (NEON); x86
+    // cores with a fast scalar divider gain little. Formats whose
+    // operator/ needs more than 64 bits (Q32.32) use operator/.
+    template<division_accuracy Accuracy = division_accuracy::exact, is_fixed T>
+    static inline void
+    div(const T* a, const T* b, T* out, std::size_t n) {
+        using Numerator = detail::divide::numerator_t<T>;
+
+        if constexpr (sizeof(detail::divide::magnitude_t<T>) > sizeof(std::uint64_t)) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = a[i] / b[i];
+            }
+        } else {
+            #pragma omp simd
+            for (std::size_t i = 0; i < n; i++) {
+                const Numerator numerator = static_cast<Numerator>(static_cast<Numerator>(a[i].raw) << T::FracBits);
+                out[i] = detail::divide::newton_divide<Accuracy, T>(numerator, b[i].raw);
+            }
+        }
+    }
+
+    // out[i] = 1 / in[i], the same as div with a numerator of exactly
+    // 1.0, even for formats such as Q0.15 that cannot represent it
+    template<division_accuracy Accuracy = division_accuracy::exact, is_fixed T>
+    requires (2 * T::FracBits < sizeof(detail::divide::numerator_t<T>) * 8 - (is_signed_integer<detail::divide::numerator_t<T>> ? 1 : 0))
+    static inline void
+    reciprocal(const T* in, T* out, std::size_t n) {
+        using Numerator = detail::divide::numerator_t<T>;
+
+        constexpr Numerator One = static_cast<Numerator>(1) << (2 * T::FracBits);
+
+        if constexpr (sizeof(detail::divide::magnitude_t<T>) > sizeof(std::uint64_t)) {
+            using Storage = typename T::storage_type;
+
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = T::from_raw(static_cast<Storage>(One / in[i].raw));
+            }
+        } else {
+            #pragma omp simd
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = detail::divide::newton_divide<Accuracy, T>(One, in[i].raw);
+            }
+        }
+    }
+}
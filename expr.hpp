@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <fixp.hpp>
+#include <ranges>
+
+// Lazy element-wise expressions over arrays of fixed values. Building
+// an expression does no work, assign() evaluates the whole thing in a
+// single loop, so
+//
+//   fixp::expr::assign(y, fixp::lazy(a, n) * fixp::lazy(x, n) + b);
+//
+// reads a and x once and writes y once, where separate bulk passes
+// would write and re-read a temporary for every operator. Each element
+// is computed with the ordinary fixed operators, so the result is
+// exactly what a hand-written loop would give. Arrays combined in one
+// expression must have the same length (checked with assert).
+namespace fixp {
+    namespace expr {
+        template<typename E>
+        concept is_expression = is_fixed<typename E::value_type> && requires(const E& e, std::size_t i) {
+            { e[i] } -> std::same_as<typename E::value_type>;
+        };
+
+        // Expressions with a length, i.e. anything other than a
+        // broadcast scalar
+        template<typename E>
+        concept is_sized_expression = is_expression<E> && requires(const E& e) {
+            { e.size() } -> std::same_as<std::size_t>;
+        };
+
+        // n values starting at data, which must outlive the expression
+        template<is_fixed T>
+        struct ref {
+            using value_type = T;
+
+            const T* data;
+            std::size_t n;
+
+            constexpr T operator[](std::size_t i) const { return data[i]; }
+            constexpr std::size_t size() const { return n; }
+        };
+
+        // A single value broadcast to every element
+        template<is_fixed T>
+        struct scalar {
+            using value_type = T;
+
+            T value;
+
+            constexpr T operator[](std::size_t) const { return value; }
+        };
+
+        template<typename Op, is_expression L, is_expression R>
+        struct binary {
+            using value_type = typename L::value_type;
+
+            L lhs;
+            R rhs;
+
+            constexpr value_type operator[](std::size_t i) const { return Op {}(lhs[i], rhs[i]); }
+
+            constexpr std::size_t size() const requires (is_sized_expression<L> || is_sized_expression<R>) {
+                if constexpr (is_sized_expression<L>) {
+                    return lhs.size();
+                } else {
+                    return rhs.size();
+                }
+            }
+        };
+
+        template<typename Op, is_sized_expression E>
+        struct unary {
+            using value_type = typename E::value_type;
+
+            E operand;
+
+            constexpr value_type operator[](std::size_t i) const { return Op {}(operand[i]); }
+            constexpr std::size_t size() const { return operand.size(); }
+        };
+
+        namespace detail {
+            template<typename Op, is_expression L, is_expression R>
+            requires std::same_as<typename L::value_type, typename R::value_type>
+                  && (is_sized_expression<L> || is_sized_expression<R>)
+            static constexpr binary<Op, L, R> make_binary(const L& lhs, const R& rhs) {
+                // size() only looks at one side, and assign() trusts it
+                if constexpr (is_sized_expression<L> && is_sized_expression<R>) {
+                    assert(lhs.size() == rhs.size());
+                }
+
+                return { lhs, rhs };
+            }
+        }
+
+        #define FIXP_EXPR_OPERATOR(OP, FUNCTOR)                                                        \
+            template<is_expression L, is_expression R>                                                 \
+            static constexpr auto operator OP(const L& lhs, const R& rhs) {                            \
+                return detail::make_binary<FUNCTOR>(lhs, rhs);                                         \
+            }                                                                                          \
+                                                                                                       \
+            template<is_sized_expression L>                                                            \
+            static constexpr auto operator OP(const L& lhs, const typename L::value_type& rhs) {        \
+                return detail::make_binary<FUNCTOR>(lhs, scalar<typename L::value_type> { rhs });      \
+            }                                                                                          \
+                                                                                                       \
+            template<is_sized_expression R>                                                            \
+            static constexpr auto operator OP(const typename R::value_type& lhs, const R& rhs) {       \
+                return detail::make_binary<FUNCTOR>(scalar<typename R::value_type> { lhs }, rhs);      \
+            }
+
+        FIXP_EXPR_OPERATOR(+, std::plus<>)
+        FIXP_EXPR_OPERATOR(-, std::minus<>)
+        FIXP_EXPR_OPERATOR(*, std::multiplies<>)
+        FIXP_EXPR_OPERATOR(/, std::divides<>)
+        #undef FIXP_EXPR_OPERATOR
+
+        template<is_sized_expression E>
+        static constexpr unary<std::negate<>, E> operator-(const E& e) {
+            return { e };
+        }
+
+        // out[i] = e[i] for every element of e, in one pass. out may
+        // be one of the arrays e reads from
+        template<is_sized_expression E>
+        static inline void
+        assign(typename E::value_type* out, const E& e) {
+            const std::size_t n = e.size();
+
+            #pragma omp simd
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = e[i];
+            }
+        }
+    }
+
+    template<is_fixed T>
+    static constexpr expr::ref<T> lazy(const T* data, std::size_t n) {
+        return { data, n };
+    }
+
+    template<std::ranges::contiguous_range R>
+    requires is_fixed<std::ranges::range_value_t<R>>
+    static constexpr auto lazy(const R& range) {
+        return lazy(std::ranges::data(range), std::ranges::size(range));
+    }
+}
@@ -0,0 +1,464 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <complex.hpp>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <fixp.hpp>
+#include <hints.hpp>
+#include <utility>
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace fixp::dsp {
+    enum class fft_scaling {
+        // No scaling at all, the caller has to guarantee enough
+        // headroom
+        none,
+        // Halve after every radix-2 stage, i.e. the result is scaled
+        // by 1/N. Inputs should stay below 1/sqrt(2) of full scale.
+        per_stage,
+        // Only shift down a stage when the data would otherwise
+        // overflow
+        block_floating_point,
+    };
+
+    // In-place complex FFT over N interleaved (re, im) pairs of T.
+    //
+    // forward() and inverse() return the block exponent e, the true
+    // result being data * 2^e. The inverse is not normalized, so
+    // subtract log2(N) from its exponent to get the actual inverse
+    // transform.
+    //
+    // Decimation in time. The two leading radix-2 stages are fused
+    // into a single multiplier-free radix-4 pass, and all remaining
+    // stages read their twiddles contiguously.
+    template<is_fixed T, const std::size_t N, const fft_scaling Scaling = fft_scaling::block_floating_point>
+    requires (N >= 4 && std::has_single_bit(N)
+              && sizeof(typename T::intermediate_type) >= 2 * sizeof(typename T::storage_type))
+    class fft final {
+        public:
+            using value_type = T;
+
+            static constexpr std::size_t Size = N;
+            static constexpr int Log2Size = std::countr_zero(N);
+
+        private:
+            using Storage = typename T::storage_type;
+            using Intermediate = typename T::intermediate_type;
+
+            // Twiddles get their own format with one integral bit so
+            // that 1.0 is exactly representable, independent of T
+            static constexpr int TwiddleBits = sizeof(Storage) * 8 - 2;
+
+            // Twiddles for the stage combining blocks of h are stored
+            // at [h - 1, 2h - 1)
+            struct twiddle_table {
+                std::array<Storage, N> re;
+                std::array<Storage, N> im;
+            };
+
+            static constexpr twiddle_table Twiddles = ([]() constexpr {
+                twiddle_table table = { };
+
+                for (std::size_t h = 1; h < N; h *= 2) {
+                    for (std::size_t j = 0; j < h; j++) {
+                        const double angle = std::numbers::pi_v<double> * static_cast<double>(j) / static_cast<double>(h);
+                        const double scale = static_cast<double>(Intermediate { 1 } << TwiddleBits);
+
+                        table.re[h - 1 + j] = fixp::detail::math::round_cexpr<Storage>(fixp::detail::math::cos_cexpr(angle) * scale);
+                        table.im[h - 1 + j] = fixp::detail::math::round_cexpr<Storage>(-fixp::detail::math::sin_cexpr(angle) * scale);
+                    }
+                }
+
+                return table;
+            })();
+
+            // Largest magnitude for which a stage is guaranteed not to
+            // overflow (a radix-4 pass grows by at most 4, a radix-2
+            // butterfly by at most 1 + sqrt(2))
+            static constexpr Intermediate Headroom = Intermediate { 1 } << (sizeof(Storage) * 8 - 3);
+
+            static constexpr int
+            stage_shift(Intermediate max, int radix2_stages) {
+                if constexpr (Scaling == fft_scaling::none) {
+                    return 0;
+                } else if constexpr (Scaling == fft_scaling::per_stage) {
+                    return radix2_stages;
+                } else {
+                    int shift = 0;
+
+                    while (shift < 2 && (max >> shift) >= Headroom) {
+                        shift++;
+                    }
+
+                    return shift;
+                }
+            }
+
+            FIXP_ALWAYS_INLINE static constexpr Storage
+            narrow(Intermediate x, int shift) {
+                const Intermediate half = shift > 0 ? Intermediate { 1 } << (shift - 1) : 0;
+                return static_cast<Storage>((x + half) >> shift);
+            }
+
+            FIXP_ALWAYS_INLINE static constexpr Intermediate
+            magnitude(Storage x) {
+                const Intermediate wide = x;
+                return wide < 0 ? -wide : wide;
+            }
+
+            static void
+            bit_reverse(T* data) {
+                for (std::size_t i = 1, j = 0; i < N; i++) {
+                    std::size_t bit = N >> 1;
+
+                    while (j & bit) {
+                        j ^= bit;
+                        bit >>= 1;
+                    }
+
+                    j ^= bit;
+
+                    if (i < j) {
+                        std::swap(data[2 * i], data[2 * j]);
+                        std::swap(data[2 * i + 1], data[2 * j + 1]);
+                    }
+                }
+            }
+
+            static Intermediate
+            max_magnitude(const T* data) {
+                Intermediate max = 0;
+
+                for (std::size_t i = 0; i < 2 * N; i++) {
+                    max = std::max(max, magnitude(data[i].raw));
+                }
+
+                return max;
+            }
+
+            // The first two stages have trivial twiddles (1 and -j)
+            template<bool Inverse>
+            static Intermediate
+            radix4_pass(T* data, int shift) {
+                Intermediate max = 0;
+
+                for (std::size_t i = 0; i < N; i += 4) {
+                    T* x = &data[2 * i];
+
+                    const Intermediate p0r = Intermediate { x[0].raw } + x[2].raw;
+                    const Intermediate p0i = Intermediate { x[1].raw } + x[3].raw;
+                    const Intermediate p1r = Intermediate { x[0].raw } - x[2].raw;
+                    const Intermediate p1i = Intermediate { x[1].raw } - x[3].raw;
+                    const Intermediate p2r = Intermediate { x[4].raw } + x[6].raw;
+                    const Intermediate p2i = Intermediate { x[5].raw } + x[7].raw;
+                    const Intermediate p3r = Intermediate { x[4].raw } - x[6].raw;
+                    const Intermediate p3i = Intermediate { x[5].raw } - x[7].raw;
+
+                    // -j * p3 going forward, +j * p3 for the inverse
+                    const Intermediate rr = Inverse ? -p3i : p3i;
+                    const Intermediate ri = Inverse ? p3r : -p3r;
+
+                    x[0].raw = narrow(p0r + p2r, shift);
+                    x[1].raw = narrow(p0i + p2i, shift);
+                    x[2].raw = narrow(p1r + rr, shift);
+                    x[3].raw = narrow(p1i + ri, shift);
+                    x[4].raw = narrow(p0r - p2r, shift);
+                    x[5].raw = narrow(p0i - p2i, shift);
+                    x[6].raw = narrow(p1r - rr, shift);
+                    x[7].raw = narrow(p1i - ri, shift);
+
+                    if constexpr (Scaling == fft_scaling::block_floating_point) {
+                        for (std::size_t j = 0; j < 8; j++) {
+                            max = std::max(max, magnitude(x[j].raw));
+                        }
+                    }
+                }
+
+                return max;
+            }
+
+            template<bool Inverse>
+            static Intermediate
+            radix2_stage(T* data, std::size_t h, int shift) {
+                const Storage* wr = &Twiddles.re[h - 1];
+                const Storage* wi = &Twiddles.im[h - 1];
+                const int total_shift = TwiddleBits + shift;
+
+                Intermediate max = 0;
+
+                for (std::size_t k = 0; k < N; k += 2 * h) {
+                    T* a = &data[2 * k];
+                    T* b = &data[2 * (k + h)];
+                    std::size_t j = 0;
+
+                    #ifdef __ARM_NEON
+                    if constexpr (std::same_as<Storage, std::int16_t> && std::same_as<Intermediate, std::int32_t>) {
+                        const int32x4_t vshift = vdupq_n_s32(-total_shift);
+                        int16x8_t vmax = vdupq_n_s16(0);
+
+                        for (; j + 8 <= h; j += 8) {
+                            const int16x8x2_t va = vld2q_s16(&a[2 * j].raw);
+                            const int16x8x2_t vb = vld2q_s16(&b[2 * j].raw);
+                            const int16x8_t vwr = vld1q_s16(&wr[j]);
+                            const int16x8_t vwi = Inverse ? vnegq_s16(vld1q_s16(&wi[j])) : vld1q_s16(&wi[j]);
+
+                            // t = w * b
+                            const int32x4_t tr_lo = vmlsl_s16(vmull_s16(vget_low_s16(vb.val[0]), vget_low_s16(vwr)), vget_low_s16(vb.val[1]), vget_low_s16(vwi));
+                            const int32x4_t tr_hi = vmlsl_high_s16(vmull_high_s16(vb.val[0], vwr), vb.val[1], vwi);
+                            const int32x4_t ti_lo = vmlal_s16(vmull_s16(vget_low_s16(vb.val[0]), vget_low_s16(vwi)), vget_low_s16(vb.val[1]), vget_low_s16(vwr));
+                            const int32x4_t ti_hi = vmlal_high_s16(vmull_high_s16(vb.val[0], vwi), vb.val[1], vwr);
+
+                            const int32x4_t ar_lo = vshll_n_s16(vget_low_s16(va.val[0]), TwiddleBits);
+                            const int32x4_t ar_hi = vshll_high_n_s16(va.val[0], TwiddleBits);
+                            const int32x4_t ai_lo = vshll_n_s16(vget_low_s16(va.val[1]), TwiddleBits);
+                            const int32x4_t ai_hi = vshll_high_n_s16(va.val[1], TwiddleBits);
+
+                            int16x8x2_t vtop;
+                            int16x8x2_t vbottom;
+
+                            vtop.val[0] = vcombine_s16(vmovn_s32(vrshlq_s32(vaddq_s32(ar_lo, tr_lo), vshift)), vmovn_s32(vrshlq_s32(vaddq_s32(ar_hi, tr_hi), vshift)));
+                            vtop.val[1] = vcombine_s16(vmovn_s32(vrshlq_s32(vaddq_s32(ai_lo, ti_lo), vshift)), vmovn_s32(vrshlq_s32(vaddq_s32(ai_hi, ti_hi), vshift)));
+                            vbottom.val[0] = vcombine_s16(vmovn_s32(vrshlq_s32(vsubq_s32(ar_lo, tr_lo), vshift)), vmovn_s32(vrshlq_s32(vsubq_s32(ar_hi, tr_hi), vshift)));
+                            vbottom.val[1] = vcombine_s16(vmovn_s32(vrshlq_s32(vsubq_s32(ai_lo, ti_lo), vshift)), vmovn_s32(vrshlq_s32(vsubq_s32(ai_hi, ti_hi), vshift)));
+
+                            vst2q_s16(&a[2 * j].raw, vtop);
+                            vst2q_s16(&b[2 * j].raw, vbottom);
+
+                            if constexpr (Scaling == fft_scaling::block_floating_point) {
+                                vmax = vmaxq_s16(vmax, vmaxq_s16(vqabsq_s16(vtop.val[0]), vqabsq_s16(vtop.val[1])));
+                                vmax = vmaxq_s16(vmax, vmaxq_s16(vqabsq_s16(vbottom.val[0]), vqabsq_s16(vbottom.val[1])));
+                            }
+                        }
+
+                        max = std::max(max, static_cast<Intermediate>(vmaxvq_s16(vmax)));
+                    } else if constexpr (std::same_as<Storage, std::int32_t> && std::same_as<Intermediate, std::int64_t>) {
+                        const int64x2_t vshift = vdupq_n_s64(-total_shift);
+                        int32x4_t vmax = vdupq_n_s32(0);
+
+                        for (; j + 4 <= h; j += 4) {
+                            const int32x4x2_t va = vld2q_s32(&a[2 * j].raw);
+                            const int32x4x2_t vb = vld2q_s32(&b[2 * j].raw);
+                            const int32x4_t vwr = vld1q_s32(&wr[j]);
+                            const int32x4_t vwi = Inverse ? vnegq_s32(vld1q_s32(&wi[j])) : vld1q_s32(&wi[j]);
+
+                            const int64x2_t tr_lo = vmlsl_s32(vmull_s32(vget_low_s32(vb.val[0]), vget_low_s32(vwr)), vget_low_s32(vb.val[1]), vget_low_s32(vwi));
+                            const int64x2_t tr_hi = vmlsl_high_s32(vmull_high_s32(vb.val[0], vwr), vb.val[1], vwi);
+                            const int64x2_t ti_lo = vmlal_s32(vmull_s32(vget_low_s32(vb.val[0]), vget_low_s32(vwi)), vget_low_s32(vb.val[1]), vget_low_s32(vwr));
+                            const int64x2_t ti_hi = vmlal_high_s32(vmull_high_s32(vb.val[0], vwi), vb.val[1], vwr);
+
+                            const int64x2_t ar_lo = vshll_n_s32(vget_low_s32(va.val[0]), TwiddleBits);
+                            const int64x2_t ar_hi = vshll_high_n_s32(va.val[0], TwiddleBits);
+                            const int64x2_t ai_lo = vshll_n_s32(vget_low_s32(va.val[1]), TwiddleBits);
+                            const int64x2_t ai_hi = vshll_high_n_s32(va.val[1], TwiddleBits);
+
+                            int32x4x2_t vtop;
+                            int32x4x2_t vbottom;
+
+                            vtop.val[0] = vcombine_s32(vmovn_s64(vrshlq_s64(vaddq_s64(ar_lo, tr_lo), vshift)), vmovn_s64(vrshlq_s64(vaddq_s64(ar_hi, tr_hi), vshift)));
+                            vtop.val[1] = vcombine_s32(vmovn_s64(vrshlq_s64(vaddq_s64(ai_lo, ti_lo), vshift)), vmovn_s64(vrshlq_s64(vaddq_s64(ai_hi, ti_hi), vshift)));
+                            vbottom.val[0] = vcombine_s32(vmovn_s64(vrshlq_s64(vsubq_s64(ar_lo, tr_lo), vshift)), vmovn_s64(vrshlq_s64(vsubq_s64(ar_hi, tr_hi), vshift)));
+                            vbottom.val[1] = vcombine_s32(vmovn_s64(vrshlq_s64(vsubq_s64(ai_lo, ti_lo), vshift)), vmovn_s64(vrshlq_s64(vsubq_s64(ai_hi, ti_hi), vshift)));
+
+                            vst2q_s32(&a[2 * j].raw, vtop);
+                            vst2q_s32(&b[2 * j].raw, vbottom);
+
+                            if constexpr (Scaling == fft_scaling::block_floating_point) {
+                                vmax = vmaxq_s32(vmax, vmaxq_s32(vqabsq_s32(vtop.val[0]), vqabsq_s32(vtop.val[1])));
+                                vmax = vmaxq_s32(vmax, vmaxq_s32(vqabsq_s32(vbottom.val[0]), vqabsq_s32(vbottom.val[1])));
+                            }
+                        }
+
+                        max = std::max(max, static_cast<Intermediate>(vmaxvq_s32(vmax)));
+                    }
+                    #endif
+
+                    for (; j < h; j++) {
+                        const Intermediate br = b[2 * j].raw;
+                        const Intermediate bi = b[2 * j + 1].raw;
+                        const Intermediate w_r = wr[j];
+                        const Intermediate w_i = Inverse ? -wi[j] : wi[j];
+
+                        const Intermediate tr = br * w_r - bi * w_i;
+                        const Intermediate ti = br * w_i + bi * w_r;
+                        const Intermediate ar = Intermediate { a[2 * j].raw } << TwiddleBits;
+                        const Intermediate ai = Intermediate { a[2 * j + 1].raw } << TwiddleBits;
+
+                        a[2 * j].raw = narrow(ar + tr, total_shift);
+                        a[2 * j + 1].raw = narrow(ai + ti, total_shift);
+                        b[2 * j].raw = narrow(ar - tr, total_shift);
+                        b[2 * j + 1].raw = narrow(ai - ti, total_shift);
+
+                        if constexpr (Scaling == fft_scaling::block_floating_point) {
+                            max = std::max({ max, magnitude(a[2 * j].raw), magnitude(a[2 * j + 1].raw),
+                                             magnitude(b[2 * j].raw), magnitude(b[2 * j + 1].raw) });
+                        }
+                    }
+                }
+
+                return max;
+            }
+
+            template<bool Inverse>
+            static int
+            transform(T* data) {
+                bit_reverse(data);
+
+                Intermediate max = 0;
+                if constexpr (Scaling == fft_scaling::block_floating_point) {
+                    max = max_magnitude(data);
+                }
+
+                int exponent = stage_shift(max, 2);
+                max = radix4_pass<Inverse>(data, exponent);
+
+                for (std::size_t h = 4; h < N; h *= 2) {
+                    const int shift = stage_shift(max, 1);
+
+                    max = radix2_stage<Inverse>(data, h, shift);
+                    exponent += shift;
+                }
+
+                return exponent;
+            }
+
+        public:
+            static int forward(T* data) { return transform<false>(data); }
+            static int inverse(T* data) { return transform<true>(data); }
+
+            static int forward(complex<T>* data) { return forward(&data[0].re); }
+            static int inverse(complex<T>* data) { return inverse(&data[0].re); }
+    };
+
+    // Forward FFT of N real samples, computed as an N/2 point complex
+    // FFT followed by a split step. Writes the N/2 + 1 non-redundant
+    // bins as interleaved (re, im) pairs, so out must hold N + 2
+    // values; in and out may alias. Returns the block exponent like
+    // fft::forward(); with any scaling enabled the split step costs
+    // one extra bit.
+    template<is_fixed T, const std::size_t N, const fft_scaling Scaling = fft_scaling::block_floating_point>
+    requires (N >= 8)
+    class rfft final {
+        public:
+            using value_type = T;
+
+            static constexpr std::size_t Size = N;
+            static constexpr std::size_t Bins = N / 2 + 1;
+
+        private:
+            using Storage = typename T::storage_type;
+            using complex_fft = fft<T, N / 2, Scaling>;
+
+            // The split step works in the intermediate type, but never
+            // narrower than 64 bits so that Q15 keeps 14 bit twiddles.
+            // sr << TwiddleBits plus |W| * |d| stays below 2^(S + TB + 2)
+            // for S bit storage, so the twiddles get what is left of the
+            // accumulator after that.
+            using Accumulator = std::conditional_t<(sizeof(typename T::intermediate_type) > sizeof(std::int64_t)),
+                                                   typename T::intermediate_type, std::int64_t>;
+
+            static constexpr std::size_t M = N / 2;
+            static constexpr int StorageBits = sizeof(Storage) * 8;
+            static constexpr int TwiddleBits = std::min(StorageBits - 2, static_cast<int>(sizeof(Accumulator) * 8) - StorageBits - 3);
+            static constexpr int SplitShift = TwiddleBits + (Scaling == fft_scaling::none ? 1 : 2);
+
+            struct twiddle_table {
+                std::array<Storage, M / 2 + 1> cos;
+                std::array<Storage, M / 2 + 1> sin;
+            };
+
+            // W_N^k = cos + j sin for k in [0, N/4]
+            static constexpr twiddle_table Twiddles = ([]() constexpr {
+                twiddle_table table = { };
+
+                for (std::size_t k = 0; k <= M / 2; k++) {
+                    const double angle = 2.0 * std::numbers::pi_v<double> * static_cast<double>(k) / static_cast<double>(N);
+                    const double scale = static_cast<double>(std::int64_t { 1 } << TwiddleBits);
+
+                    table.cos[k] = fixp::detail::math::round_cexpr<Storage>(fixp::detail::math::cos_cexpr(angle) * scale);
+                    table.sin[k] = fixp::detail::math::round_cexpr<Storage>(-fixp::detail::math::sin_cexpr(angle) * scale);
+                }
+
+                return table;
+            })();
+
+            // X[k] = (Z[k] + conj(Z[M - k])) / 2 - j W^k (Z[k] - conj(Z[M - k])) / 2
+            FIXP_ALWAYS_INLINE static constexpr void
+            split(Accumulator zr, Accumulator zi, Accumulator mr, Accumulator mi,
+                  Accumulator c, Accumulator s, T* out) {
+                constexpr Accumulator half = Accumulator { 1 } << (SplitShift - 1);
+
+                const Accumulator sr = zr + mr;
+                const Accumulator si = zi - mi;
+                const Accumulator dr = zr - mr;
+                const Accumulator di = zi + mi;
+
+                out[0].raw = static_cast<Storage>(((sr << TwiddleBits) + s * dr + c * di + half) >> SplitShift);
+                out[1].raw = static_cast<Storage>(((si << TwiddleBits) + s * di - c * dr + half) >> SplitShift);
+            }
+
+        public:
+            static int forward(const T* in, complex<T>* out) {
+                return forward(in, &out[0].re);
+            }
+
+            static int forward(const T* in, T* out) {
+                // Pairs of real samples are reinterpreted as complex
+                // samples, which is the same memory layout
+                if (in != out) {
+                    std::copy(in, in + N, out);
+                }
+
+                int exponent = complex_fft::forward(out);
+
+                if constexpr (Scaling != fft_scaling::none) {
+                    exponent += 1;
+                }
+
+                // Z[M] aliases Z[0]
+                out[2 * M] = out[0];
+                out[2 * M + 1] = out[1];
+
+                for (std::size_t k = 0; k <= M / 2; k++) {
+                    const Accumulator zr = out[2 * k].raw;
+                    const Accumulator zi = out[2 * k + 1].raw;
+                    const Accumulator mr = out[2 * (M - k)].raw;
+                    const Accumulator mi = out[2 * (M - k) + 1].raw;
+
+                    split(zr, zi, mr, mi, Twiddles.cos[k], Twiddles.sin[k], &out[2 * k]);
+
+                    // W^(M - k) = -conj(W^k)
+                    split(mr, mi, zr, zi, -Twiddles.cos[k], Twiddles.sin[k], &out[2 * (M - k)]);
+                }
+
+                return exponent;
+            }
+    };
+}
@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <fixp.hpp>
+#include <hints.hpp>
+#include <limits>
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace fixp::dsp {
+    namespace detail {
+        // Sum of a[i] * b[i] accumulated at full precision, i.e. with
+        // no shifting of the individual products.
+        template<is_signed_integer Accumulator, std::signed_integral S>
+        FIXP_ALWAYS_INLINE static inline Accumulator
+        dot(const S* a, const S* b, std::size_t n) {
+            Accumulator sum = 0;
+            std::size_t i = 0;
+
+            #ifdef __ARM_NEON
+            if constexpr (std::same_as<S, std::int16_t> && std::same_as<Accumulator, std::int32_t>) {
+                int32x4_t acc[4] = { vdupq_n_s32(0), vdupq_n_s32(0), vdupq_n_s32(0), vdupq_n_s32(0) };
+
+                for (; i + 16 <= n; i += 16) {
+                    const int16x8_t a0 = vld1q_s16(&a[i]);
+                    const int16x8_t a1 = vld1q_s16(&a[i + 8]);
+                    const int16x8_t b0 = vld1q_s16(&b[i]);
+                    const int16x8_t b1 = vld1q_s16(&b[i + 8]);
+
+                    acc[0] = vmlal_s16(acc[0], vget_low_s16(a0), vget_low_s16(b0));
+                    acc[1] = vmlal_high_s16(acc[1], a0, b0);
+                    acc[2] = vmlal_s16(acc[2], vget_low_s16(a1), vget_low_s16(b1));
+                    acc[3] = vmlal_high_s16(acc[3], a1, b1);
+                }
+
+                sum = vaddvq_s32(vaddq_s32(vaddq_s32(acc[0], acc[1]), vaddq_s32(acc[2], acc[3])));
+            } else if constexpr (std::same_as<S, std::int16_t> && std::same_as<Accumulator, std::int64_t>) {
+                // Each int16 product fits in 31 bits, so pairs of them
+                // are widened and added into 64 bit lanes (vpadal)
+                int64x2_t acc[4] = { vdupq_n_s64(0), vdupq_n_s64(0), vdupq_n_s64(0), vdupq_n_s64(0) };
+
+                for (; i + 16 <= n; i += 16) {
+                    const int16x8_t a0 = vld1q_s16(&a[i]);
+                    const int16x8_t a1 = vld1q_s16(&a[i + 8]);
+                    const int16x8_t b0 = vld1q_s16(&b[i]);
+                    const int16x8_t b1 = vld1q_s16(&b[i + 8]);
+
+                    acc[0] = vpadalq_s32(acc[0], vmull_s16(vget_low_s16(a0), vget_low_s16(b0)));
+                    acc[1] = vpadalq_s32(acc[1], vmull_high_s16(a0, b0));
+                    acc[2] = vpadalq_s32(acc[2], vmull_s16(vget_low_s16(a1), vget_low_s16(b1)));
+                    acc[3] = vpadalq_s32(acc[3], vmull_high_s16(a1, b1));
+                }
+
+                sum = vaddvq_s64(vaddq_s64(vaddq_s64(acc[0], acc[1]), vaddq_s64(acc[2], acc[3])));
+            } else if constexpr (std::same_as<S, std::int32_t> && std::same_as<Accumulator, std::int64_t>) {
+                int64x2_t acc[4] = { vdupq_n_s64(0), vdupq_n_s64(0), vdupq_n_s64(0), vdupq_n_s64(0) };
+
+                for (; i + 8 <= n; i += 8) {
+                    const int32x4_t a0 = vld1q_s32(&a[i]);
+                    const int32x4_t a1 = vld1q_s32(&a[i + 4]);
+                    const int32x4_t b0 = vld1q_s32(&b[i]);
+                    const int32x4_t b1 = vld1q_s32(&b[i + 4]);
+
+                    acc[0] = vmlal_s32(acc[0], vget_low_s32(a0), vget_low_s32(b0));
+                    acc[1] = vmlal_high_s32(acc[1], a0, b0);
+                    acc[2] = vmlal_s32(acc[2], vget_low_s32(a1), vget_low_s32(b1));
+                    acc[3] = vmlal_high_s32(acc[3], a1, b1);
+                }
+
+                sum = vaddvq_s64(vaddq_s64(vaddq_s64(acc[0], acc[1]), vaddq_s64(acc[2], acc[3])));
+            }
+            #endif
+
+            #pragma omp simd reduction(+:sum)
+            for (std::size_t j = i; j < n; j++) {
+                sum += static_cast<Accumulator>(a[j]) * static_cast<Accumulator>(b[j]);
+            }
+
+            return sum;
+        }
+
+        // Narrow a full precision accumulator back to T, rounding to
+        // nearest with a single shift. Results outside the range of T
+        // (a filter with gain above 1) saturate instead of wrapping.
+        template<is_fixed T, is_signed_integer Accumulator>
+        FIXP_ALWAYS_INLINE static constexpr T
+        narrow(Accumulator acc) {
+            using Storage = typename T::storage_type;
+
+            if constexpr (T::FracBits > 0) {
+                acc += static_cast<Accumulator>(1) << (T::FracBits - 1);
+            }
+
+            acc >>= T::FracBits;
+
+            if constexpr (sizeof(Accumulator) > sizeof(Storage)) {
+                acc = std::clamp<Accumulator>(acc, std::numeric_limits<Storage>::min(), std::numeric_limits<Storage>::max());
+            }
+
+            return T::from_raw(static_cast<Storage>(acc));
+        }
+
+        // Circular sample history stored twice back to back, so the
+        // most recent N samples are always contiguous (oldest first)
+        // regardless of where the write head is. Pushing a sample
+        // costs two stores instead of a memmove of the whole window.
+        template<is_signed_integer S, const std::size_t N>
+        class history final {
+            private:
+                std::array<S, 2 * N> samples = { };
+                std::size_t head = 0;
+
+            public:
+                constexpr void push(S x) {
+                    samples[head] = x;
+                    samples[head + N] = x;
+
+                    head = head + 1 == N ? 0 : head + 1;
+                }
+
+                constexpr const S* window() const { return &samples[head]; }
+
+                constexpr void reset() {
+                    samples.fill(0);
+                    head = 0;
+                }
+        };
+    }
+
+    // Streaming FIR filter. State is kept across calls to process(),
+    // so a signal may be fed in blocks of any size.
+    template<is_fixed T,
+             const std::size_t Taps,
+             is_signed_integer Accumulator = accumulator_t<T>>
+    requires (Taps > 0 && sizeof(Accumulator) >= sizeof(typename T::intermediate_type))
+    class fir final {
+        public:
+            using value_type = T;
+            using storage_type = typename T::storage_type;
+            using accumulator_type = Accumulator;
+
+            static constexpr std::size_t NumTaps = Taps;
+
+        private:
+            // Stored in reverse so that the convolution becomes a
+            // straight dot product against the (oldest first) history
+            std::array<storage_type, Taps> reversed;
+            detail::history<storage_type, Taps> state;
+
+        public:
+            constexpr fir(const std::array<T, Taps>& coefficients) {
+                for (std::size_t i = 0; i < Taps; i++) {
+                    reversed[i] = coefficients[Taps - 1 - i].raw;
+                }
+            }
+
+            constexpr void reset() { state.reset(); }
+
+            constexpr void push(const T& x) { state.push(x.raw); }
+
+            // Filter output for the samples pushed so far
+            T output() const {
+                return detail::narrow<T>(detail::dot<Accumulator>(reversed.data(), state.window(), Taps));
+            }
+
+            T process(const T& x) {
+                push(x);
+                return output();
+            }
+
+            void process(const T* in, T* out, std::size_t n) {
+                for (std::size_t i = 0; i < n; i++) {
+                    out[i] = process(in[i]);
+                }
+            }
+    };
+
+    // Decimate by Factor, only evaluating the filter for the samples
+    // that are kept.
+    template<is_fixed T,
+             const std::size_t Taps,
+             const std::size_t Factor,
+             is_signed_integer Accumulator = accumulator_t<T>>
+    requires (Factor > 0)
+    class fir_decimator final {
+        public:
+            using value_type = T;
+
+        private:
+            fir<T, Taps, Accumulator> filter;
+            std::size_t phase = 0;
+
+        public:
+            constexpr fir_decimator(const std::array<T, Taps>& coefficients)
+                : filter(coefficients) { }
+
+            constexpr void reset() {
+                filter.reset();
+                phase = 0;
+            }
+
+            // Returns the number of samples written to out, which is at
+            // most n / Factor + 1.
+            std::size_t process(const T* in, T* out, std::size_t n) {
+                std::size_t written = 0;
+
+                for (std::size_t i = 0; i < n; i++) {
+                    filter.push(in[i]);
+
+                    if (++phase == Factor) {
+                        out[written++] = filter.output();
+                        phase = 0;
+                    }
+                }
+
+                return written;
+            }
+    };
+
+    // Interpolate by Factor. The prototype filter is split into Factor
+    // polyphase branches of Taps / Factor taps each, so the zeros of
+    // the upsampled signal are never multiplied. Note that the
+    // coefficients should carry a gain of Factor to preserve the
+    // signal level.
+    template<is_fixed T,
+             const std::size_t Taps,
+             const std::size_t Factor,
+             is_signed_integer Accumulator = accumulator_t<T>>
+    requires (Factor > 0 && Taps % Factor == 0)
+    class fir_interpolator final {
+        public:
+            using value_type = T;
+            using storage_type = typename T::storage_type;
+
+            static constexpr std::size_t PhaseTaps = Taps / Factor;
+
+        private:
+            std::array<std::array<storage_type, PhaseTaps>, Factor> phases;
+            detail::history<storage_type, PhaseTaps> state;
+
+        public:
+            constexpr fir_interpolator(const std::array<T, Taps>& coefficients) {
+                for (std::size_t p = 0; p < Factor; p++) {
+                    for (std::size_t i = 0; i < PhaseTaps; i++) {
+                        phases[p][i] = coefficients[p + (PhaseTaps - 1 - i) * Factor].raw;
+                    }
+                }
+            }
+
+            constexpr void reset() { state.reset(); }
+
+            // Writes exactly n * Factor samples to out
+            void process(const T* in, T* out, std::size_t n) {
+                for (std::size_t i = 0; i < n; i++) {
+                    state.push(in[i].raw);
+
+                    for (std::size_t p = 0; p < Factor; p++) {
+                        out[i * Factor + p] = detail::narrow<T>(
+                            detail::dot<Accumulator>(phases[p].data(), state.window(), PhaseTaps));
+                    }
+                }
+            }
+    };
+}
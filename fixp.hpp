@@ -19,22 +19,98 @@
  * THE SOFTWARE.
  */
 
+#pragma once
+
 #include <concepts>
 #include <cstdlib>
 #include <initializer_list>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <limits>
 #include <array>
+#include <algorithm>
 #include <type_traits>
 #include <cstdint>
 #include <numbers>
+#include <utility>
 
 namespace fixp {
+    // std::signed_integral only admits __int128 in GNU mode, but it is
+    // the natural intermediate for 64 bit storage
+    template<typename T>
+    concept is_signed_integer = std::signed_integral<T> || std::same_as<T, __int128>;
+
+    template<typename T>
+    concept is_unsigned_integer = (std::unsigned_integral<T> && !std::same_as<T, bool>)
+        || std::same_as<T, unsigned __int128>;
+
+    template<typename T>
+    concept is_integer = is_signed_integer<T> || is_unsigned_integer<T>;
+
+    namespace detail {
+        template<const std::size_t Bits>
+        struct int_of_bits;
+
+        template<const std::size_t Bits> requires (Bits <= 8)
+        struct int_of_bits<Bits> { using type = std::int8_t; };
+
+        template<const std::size_t Bits> requires (Bits > 8 && Bits <= 16)
+        struct int_of_bits<Bits> { using type = std::int16_t; };
+
+        template<const std::size_t Bits> requires (Bits > 16 && Bits <= 32)
+        struct int_of_bits<Bits> { using type = std::int32_t; };
+
+        template<const std::size_t Bits> requires (Bits > 32 && Bits <= 64)
+        struct int_of_bits<Bits> { using type = std::int64_t; };
+
+        template<const std::size_t Bits> requires (Bits > 64 && Bits <= 128)
+        struct int_of_bits<Bits> { using type = __int128; };
+
+        // Smallest signed integer with at least Bits bits
+        template<const std::size_t Bits>
+        using int_of_bits_t = typename int_of_bits<Bits>::type;
+
+        template<const std::size_t Bits>
+        struct uint_of_bits;
+
+        template<const std::size_t Bits> requires (Bits <= 8)
+        struct uint_of_bits<Bits> { using type = std::uint8_t; };
+
+        template<const std::size_t Bits> requires (Bits > 8 && Bits <= 16)
+        struct uint_of_bits<Bits> { using type = std::uint16_t; };
+
+        template<const std::size_t Bits> requires (Bits > 16 && Bits <= 32)
+        struct uint_of_bits<Bits> { using type = std::uint32_t; };
+
+        template<const std::size_t Bits> requires (Bits > 32 && Bits <= 64)
+        struct uint_of_bits<Bits> { using type = std::uint64_t; };
+
+        template<const std::size_t Bits> requires (Bits > 64 && Bits <= 128)
+        struct uint_of_bits<Bits> { using type = unsigned __int128; };
+
+        // Smallest unsigned integer with at least Bits bits
+        template<const std::size_t Bits>
+        using uint_of_bits_t = typename uint_of_bits<Bits>::type;
+
+        // Type that can hold 2^FracBits: the intermediate type unless
+        // the fraction uses all of its value bits (e.g. Q0.31 with a
+        // 32 bit intermediate)
+        template<const std::size_t FracBits, is_integer Intermediate>
+        using scale_type = std::conditional_t<(sizeof(Intermediate) * 8 - (is_signed_integer<Intermediate> ? 1 : 0) > FracBits),
+                                              Intermediate,
+                                              int_of_bits_t<FracBits + 2>>;
+    }
+
+    // Unsigned storage gives UQ formats, which spend the sign bit on
+    // precision. Storage and Intermediate must agree on signedness.
     template<const std::size_t FractionalBits,
-             std::signed_integral Storage = std::int16_t,
-             std::signed_integral Intermediate = std::int32_t>
-    requires (sizeof(Storage) * 8 > FractionalBits && sizeof(Intermediate) >= sizeof(Storage))
+             is_integer Storage = std::int16_t,
+             is_integer Intermediate = std::int32_t>
+    requires (sizeof(Storage) * 8 - (is_signed_integer<Storage> ? 1 : 0) >= FractionalBits
+              && sizeof(Intermediate) >= sizeof(Storage)
+              && is_signed_integer<Storage> == is_signed_integer<Intermediate>)
     struct fixed final
     {
         using storage_type = Storage;
@@ -42,20 +118,49 @@ namespace fixp {
         static constexpr Storage FracBits = FractionalBits;
         static constexpr std::size_t TotalBits = sizeof(Storage) * 8;
         static constexpr std::size_t IntegralBits = TotalBits - FracBits;
-        static constexpr Storage Scale = 1 << FracBits;
-        static constexpr Storage FracMask = ((-1) << FracBits) >> FracBits;
-        static constexpr Storage IntMask = ((-1) >> FracBits) << FracBits;
-     
+        // Held in the intermediate type (or wider), formats such as
+        // Q0.15 have no room for 1.0 in their storage
+        static constexpr detail::scale_type<FractionalBits, Intermediate> Scale =
+            static_cast<detail::scale_type<FractionalBits, Intermediate>>(1) << FracBits;
+        static constexpr Storage FracMask = FracBits == TotalBits
+            ? static_cast<Storage>(~static_cast<Storage>(0))
+            : static_cast<Storage>(~(~static_cast<Storage>(0) << (FracBits % TotalBits)));
+        static constexpr Storage IntMask = static_cast<Storage>(~FracMask);
+
         Storage raw;
 
-        constexpr fixed() { }
-        constexpr fixed(const fixed& other) { raw = other.raw; }
+        // Copies, moves and default construction are all trivial, so
+        // fixed has the same layout as Storage and a buffer of raw
+        // values can be used in place (see span_view)
+        constexpr fixed() = default;
+        constexpr fixed(const fixed&) = default;
         constexpr fixed(float f) { raw = static_cast<Storage>(f * static_cast<float>(Scale)); }
 
-        template<std::signed_integral T>
+        // Rounds to the nearest raw value (ties away from zero). Only
+        // FP free when evaluated at compile time, e.g. for constexpr
+        // constants.
+        constexpr fixed(double d) {
+            const double scaled = d * static_cast<double>(Scale);
+            raw = static_cast<Storage>(scaled < 0.0 ? scaled - 0.5 : scaled + 0.5);
+        }
+
+        template<is_integer T>
         constexpr fixed(T x) { raw = static_cast<Storage>(x * Scale); }
 
-        constexpr const fixed& operator=(const fixed& other) { raw = other.raw; return *this; }
+        // Conversion from another format, a single shift. Dropped
+        // fractional bits are truncated like in operator*.
+        template<const std::size_t OtherFracBits, is_integer OtherStorage, is_integer OtherIntermediate>
+        explicit constexpr fixed(const fixed<OtherFracBits, OtherStorage, OtherIntermediate>& other) {
+            using Wide = std::conditional_t<(sizeof(OtherStorage) > sizeof(Storage)), OtherStorage, Storage>;
+
+            if constexpr (OtherFracBits > FractionalBits) {
+                raw = static_cast<Storage>(other.raw >> (OtherFracBits - FractionalBits));
+            } else {
+                raw = static_cast<Storage>(static_cast<Wide>(other.raw) << (FractionalBits - OtherFracBits));
+            }
+        }
+
+        constexpr fixed& operator=(const fixed&) = default;
 
         static constexpr fixed from_raw(Storage s) {
             fixed f;
@@ -63,6 +168,10 @@ namespace fixp {
             return f;
         }
 
+        // num / den rounded to the nearest raw value (ties away from
+        // zero) using integer arithmetic only
+        static consteval fixed from_ratio(std::intmax_t num, std::intmax_t den);
+
         constexpr explicit operator float() const {
             return static_cast<float>(raw) / static_cast<float>(Scale);
         }
@@ -77,8 +186,132 @@ namespace fixp {
     concept is_fixed = requires(T a) {
         { fixed(a) } -> std::same_as<T>;
     };
+
+    // Accumulator for long sums of values of T or of their products:
+    // the intermediate type, but at least 64 bits, so that formats with
+    // 16 bit storage have guard bits to spare
+    template<is_fixed T>
+    using accumulator_t = std::conditional_t<(sizeof(typename T::intermediate_type) >= sizeof(std::int64_t)),
+                                             typename T::intermediate_type,
+                                             std::conditional_t<is_signed_integer<typename T::storage_type>,
+                                                                std::int64_t, std::uint64_t>>;
     
     namespace detail {
+        // Deliberately not constexpr: reaching it during constant
+        // evaluation turns a bad literal into a compile error
+        void invalid_fixed_literal();
+
+        // Exact conversion of a decimal string such as "3.14159" or
+        // "1.5e-3" to the nearest raw value of T (ties away from
+        // zero). The fraction is converted to binary digit by digit,
+        // so there is no floating point rounding anywhere.
+        template<is_fixed T>
+        consteval T parse_decimal(std::string_view str) {
+            using Storage = typename T::storage_type;
+
+            constexpr std::size_t MaxDigits = 128;
+            constexpr int MaxExponent = 64;
+
+            std::array<std::uint8_t, MaxDigits> digits = { };
+            std::size_t n_digits = 0;
+            int point = -1;
+            int exponent = 0;
+
+            for (std::size_t i = 0; i < str.size(); i++) {
+                const char c = str[i];
+
+                if (c >= '0' && c <= '9') {
+                    if (n_digits == MaxDigits) {
+                        invalid_fixed_literal();
+                    }
+
+                    digits[n_digits++] = static_cast<std::uint8_t>(c - '0');
+                } else if (c == '.' && point < 0) {
+                    point = static_cast<int>(n_digits);
+                } else if (c == '\'') {
+                    continue;
+                } else if (c == 'e' || c == 'E') {
+                    int sign = 1;
+                    i++;
+
+                    if (i < str.size() && (str[i] == '-' || str[i] == '+')) {
+                        sign = str[i] == '-' ? -1 : 1;
+                        i++;
+                    }
+
+                    if (i == str.size()) {
+                        invalid_fixed_literal();
+                    }
+
+                    for (; i < str.size(); i++) {
+                        if (str[i] < '0' || str[i] > '9' || exponent > MaxExponent) {
+                            invalid_fixed_literal();
+                        }
+
+                        exponent = exponent * 10 + (str[i] - '0');
+                    }
+
+                    exponent *= sign;
+                } else {
+                    invalid_fixed_literal();
+                }
+            }
+
+            if (point < 0) {
+                point = static_cast<int>(n_digits);
+            }
+
+            point += exponent;
+
+            const auto digit = [&](int i) -> std::uint8_t {
+                return i >= 0 && i < static_cast<int>(n_digits) ? digits[i] : 0;
+            };
+
+            unsigned __int128 integral = 0;
+            for (int i = 0; i < point; i++) {
+                integral = integral * 10 + digit(i);
+
+                if (integral > static_cast<unsigned __int128>(std::numeric_limits<Storage>::max())) {
+                    invalid_fixed_literal();
+                }
+            }
+
+            std::array<std::uint8_t, MaxDigits + MaxExponent> fraction = { };
+            std::size_t n_fraction = 0;
+            for (int i = point; i < static_cast<int>(n_digits); i++) {
+                fraction[n_fraction++] = digit(i);
+            }
+
+            // Doubling the decimal fraction shifts its next binary
+            // digit into the carry. One extra bit decides rounding.
+            unsigned __int128 frac = 0;
+            for (std::size_t bit = 0; bit <= static_cast<std::size_t>(T::FracBits); bit++) {
+                std::uint8_t carry = 0;
+
+                for (std::size_t j = n_fraction; j-- > 0;) {
+                    const std::uint8_t v = fraction[j] * 2 + carry;
+                    fraction[j] = v % 10;
+                    carry = v / 10;
+                }
+
+                frac = frac * 2 + carry;
+            }
+
+            const unsigned __int128 raw = (integral << T::FracBits) + (frac >> 1) + (frac & 1);
+            if (raw > static_cast<unsigned __int128>(std::numeric_limits<Storage>::max())) {
+                invalid_fixed_literal();
+            }
+
+            return T::from_raw(static_cast<Storage>(raw));
+        }
+
+        template<std::size_t N>
+        struct literal_chars {
+            char chars[N + 1] = { };
+        };
+
+        template<char... Cs>
+        static constexpr literal_chars<sizeof...(Cs)> LiteralChars = { { Cs..., '\0' } };
         namespace math {
             template<typename T>
             static constexpr T abs_cexpr(T x) {
@@ -94,7 +327,7 @@ namespace fixp {
                 double dc = static_cast<double>(c);
                 double dprev = static_cast<double>(prev);
 
-                constexpr double epsilon = 1.0 / static_cast<double>(1 << FracBits);
+                constexpr double epsilon = 1.0 / static_cast<double>(std::uintmax_t { 1 } << FracBits);
             
                 if (abs_cexpr(dprev - dc) < epsilon) {
                     return c;
@@ -102,6 +335,46 @@ namespace fixp {
                     return sqrt_cexpr<FracBits>(x, 0.5 * (c + x / c), c);
                 }
             }
+
+            // Taylor series, only meant for generating tables at
+            // compile time
+            static constexpr double sin_cexpr(double x) {
+                constexpr double pi = std::numbers::pi_v<double>;
+
+                // reduce to [-pi, pi]
+                while (x > pi) {
+                    x -= 2.0 * pi;
+                }
+
+                while (x < -pi) {
+                    x += 2.0 * pi;
+                }
+
+                double term = x;
+                double sum = x;
+
+                for (int i = 1; i < 30; i++) {
+                    term *= -x * x / static_cast<double>((2 * i) * (2 * i + 1));
+                    sum += term;
+                }
+
+                return sum;
+            }
+
+            static constexpr double cos_cexpr(double x) {
+                return sin_cexpr(x + std::numbers::pi_v<double> / 2.0);
+            }
+
+            // 2^n, or the largest size_t for formats whose integral
+            // part is too wide for one
+            static constexpr std::size_t pow2_saturate(std::size_t n) {
+                return n < 63 ? std::size_t { 1 } << n : std::numeric_limits<std::size_t>::max();
+            }
+
+            template<std::signed_integral T>
+            static constexpr T round_cexpr(double x) {
+                return static_cast<T>(x < 0.0 ? x - 0.5 : x + 0.5);
+            }
         }
 
         template<is_fixed T>
@@ -141,34 +414,6 @@ namespace fixp {
 
             return math::abs_cexpr(quadrant) % 4;
         }
-
-        template<is_fixed T>
-        static constexpr T
-        sin_quadrant(const T& value, typename T::storage_type quadrant) {
-            // We use a Taylor expansion using coefficients stolen from here:
-            // http://www.sahraid.com/FFT/FixedPointArithmatic
-            constexpr T a1 = -0.16605f;
-            constexpr T a2 = 0.00761f;
-
-            const T result = value * (T(1.0f) + value * value * (a1 + (a2 * value * value)));
-            const T sign = quadrant < 2 ? 1.0f : -1.0f;
-
-            return sign * result;
-        }
-
-        template<is_fixed T>
-        static constexpr T
-        cos_quadrant(const T& value, typename T::storage_type quadrant) {
-            constexpr T a1 = -0.49670f;
-            constexpr T a2 = 0.03705f;
-
-            const bool is_positive = quadrant == 0 || quadrant == 3;
-            const T sign = is_positive ? 1.0f : -1.0f;
-
-            const T result = T(1.0f) + value * (value * (a1 + value * value * a2));
-
-            return sign * result;
-        }
     }
 
     template<is_fixed T>
@@ -245,6 +490,196 @@ namespace fixp {
         return a;
     }
 
+    enum class rounding {
+        // Drop the low bits: toward zero when converting from
+        // floating point like fixed(float), an arithmetic shift
+        // (toward negative infinity) like operator* otherwise
+        truncate,
+        // To nearest, ties to even
+        nearest,
+    };
+
+    namespace detail {
+        // acc >> Shift with the given rounding
+        template<rounding Rounding, const std::size_t Shift, is_integer I>
+        static constexpr I round_shift(I acc) {
+            if constexpr (Rounding == rounding::nearest && Shift > 0) {
+                // Adding half an LSB less one, plus the LSB of the
+                // truncated result, rounds ties to even
+                constexpr I Half = static_cast<I>(I { 1 } << (Shift - 1));
+                acc += static_cast<I>(Half - 1 + ((acc >> Shift) & 1));
+            }
+
+            return static_cast<I>(acc >> Shift);
+        }
+    }
+
+    // a * b + c with the product kept at full precision in the
+    // intermediate type, so there is a single rounding instead of one
+    // after the multiply and another in a later operation
+    template<rounding Rounding = rounding::nearest, is_fixed T>
+    static constexpr T fma(const T& a, const T& b, const T& c) {
+        using Intermediate = typename T::intermediate_type;
+        using Storage = typename T::storage_type;
+
+        const Intermediate acc = static_cast<Intermediate>(static_cast<Intermediate>(a.raw) * static_cast<Intermediate>(b.raw))
+            + static_cast<Intermediate>(static_cast<Intermediate>(c.raw) << T::FracBits);
+
+        return T::from_raw(static_cast<Storage>(detail::round_shift<Rounding, T::FracBits>(acc)));
+    }
+
+    enum class poly_scheme {
+        // c0 + x * (c1 + x * (c2 + ...)), one multiply per
+        // coefficient in a serial chain
+        horner,
+        // Pairs c[2k] + c[2k+1] * x combined with x^2, x^4, ..., about
+        // as many multiplies but a dependency chain of log2(N)
+        estrin,
+    };
+
+    namespace detail {
+        // Working formats for evaluating a polynomial in T. The
+        // accumulator keeps GuardBits more fractional bits than T in
+        // the intermediate type, products are formed in the next
+        // wider type, so partial results only lose bits far below
+        // T's LSB and T is rounded to once at the end. Narrow formats
+        // get up to FracBits of guard, while Q32.32 has nothing wider
+        // than __int128 to work in and gets none.
+        template<is_fixed T>
+        struct poly_format {
+            using Storage = typename T::storage_type;
+            using Intermediate = typename T::intermediate_type;
+
+            static constexpr std::size_t StorageBits = sizeof(Storage) * 8;
+            static constexpr std::size_t IntermediateBits = sizeof(Intermediate) * 8;
+            static constexpr std::size_t WideBits = std::min<std::size_t>(128, IntermediateBits * 2);
+
+            using accumulator = Intermediate;
+            using wide = int_of_bits_t<WideBits>;
+
+            // Partial results are assumed to stay within T's range,
+            // as with any other fixed arithmetic. Estrin multiplies
+            // two accumulators, hence the WideBits / 2
+            static constexpr std::size_t GuardBits = std::min({
+                static_cast<std::size_t>(T::FracBits),
+                IntermediateBits - StorageBits,
+                WideBits / 2 - StorageBits,
+            });
+
+            static constexpr std::size_t FracBits = T::FracBits + GuardBits;
+
+            // Rounded half up, which is cheap (and a single
+            // instruction on NEON) and keeps the error from piling up
+            // when there are no guard bits
+            static constexpr accumulator mul(accumulator a, accumulator b, std::size_t shift) {
+                const wide product = static_cast<wide>(a) * static_cast<wide>(b);
+                return static_cast<accumulator>(shift > 0 ? (product + (wide { 1 } << (shift - 1))) >> shift : product);
+            }
+
+            static constexpr accumulator quantize(double c) {
+                double scaled = c;
+                for (std::size_t i = 0; i < FracBits; i++) {
+                    scaled *= 2.0;
+                }
+
+                constexpr double Limit = [] {
+                    double limit = 1.0;
+                    for (std::size_t i = 0; i < IntermediateBits - 1; i++) {
+                        limit *= 2.0;
+                    }
+                    return limit;
+                }();
+
+                if (scaled >= Limit || scaled < -Limit) {
+                    invalid_fixed_literal();
+                }
+
+                return static_cast<accumulator>(scaled < 0.0 ? scaled - 0.5 : scaled + 0.5);
+            }
+
+            // The loops are written as folds over the coefficients so
+            // they unroll with every coefficient as an immediate.
+            // The accumulator times a T only needs T::FracBits shifted
+            // out to stay at the accumulator's precision
+            template<std::size_t N>
+            static constexpr accumulator horner(const std::array<accumulator, N>& c, Storage x) {
+                accumulator acc = c[N - 1];
+
+                [&]<std::size_t... I>(std::index_sequence<I...>) {
+                    ((acc = static_cast<accumulator>(mul(acc, x, T::FracBits) + c[N - 2 - I])), ...);
+                }(std::make_index_sequence<N - 1> {});
+
+                return acc;
+            }
+
+            // power is x^(2^level) at the accumulator's precision
+            template<std::size_t N>
+            static constexpr accumulator estrin(const std::array<accumulator, N>& terms, accumulator power) {
+                if constexpr (N == 1) {
+                    return terms[0];
+                } else {
+                    std::array<accumulator, (N + 1) / 2> next;
+
+                    [&]<std::size_t... K>(std::index_sequence<K...>) {
+                        ((next[K] = static_cast<accumulator>(terms[2 * K] + mul(terms[2 * K + 1], power, FracBits))), ...);
+                    }(std::make_index_sequence<N / 2> {});
+
+                    if constexpr (N % 2) {
+                        next[N / 2] = terms[N - 1];
+                    }
+
+                    return estrin(next, mul(power, power, FracBits));
+                }
+            }
+        };
+    }
+
+    // p(x) = Coeffs[0] + Coeffs[1] * x + Coeffs[2] * x^2 + ...
+    //
+    // The coefficients are quantized at compile time for whichever
+    // format the polynomial is evaluated in, and the whole evaluation
+    // happens at extended precision (see detail::poly_format) with a
+    // single rounding back to T at the end, where writing it out with
+    // fixed operators would truncate after every multiply.
+    //
+    //   using sin_taylor = fixp::poly<0.0, 1.0, 0.0, -1.0 / 6.0>;
+    //   auto y = sin_taylor::evaluate(x);
+    //
+    // Array forms are in bulk.hpp.
+    template<double... Coeffs>
+    requires (sizeof...(Coeffs) > 0)
+    struct poly {
+        static constexpr std::size_t Degree = sizeof...(Coeffs) - 1;
+
+        template<is_fixed T>
+        requires is_signed_integer<typename T::storage_type>
+        static constexpr std::array<typename detail::poly_format<T>::accumulator, sizeof...(Coeffs)>
+        coefficients = { detail::poly_format<T>::quantize(Coeffs)... };
+
+        template<poly_scheme Scheme = poly_scheme::horner, rounding Rounding = rounding::nearest, is_fixed T>
+        requires is_signed_integer<typename T::storage_type>
+        static constexpr T evaluate(const T& x) {
+            using format = detail::poly_format<T>;
+            using accumulator = typename format::accumulator;
+            using Storage = typename T::storage_type;
+
+            accumulator acc;
+
+            if constexpr (Scheme == poly_scheme::horner) {
+                acc = format::horner(coefficients<T>, x.raw);
+            } else {
+                acc = format::estrin(coefficients<T>, static_cast<accumulator>(static_cast<accumulator>(x.raw) << format::GuardBits));
+            }
+
+            return T::from_raw(static_cast<Storage>(detail::round_shift<Rounding, format::GuardBits>(acc)));
+        }
+
+        template<is_fixed T>
+        constexpr T operator()(const T& x) const {
+            return evaluate(x);
+        }
+    };
+
     template<is_fixed T>
     static constexpr bool operator==(const T& a, const T& b) {
         return a.raw == b.raw;
@@ -270,6 +705,112 @@ namespace fixp {
         return a.raw >= b.raw;
     }
 
+    namespace detail {
+        template<is_fixed A, is_fixed B>
+        struct mixed_format {
+            static constexpr bool Unsigned = is_unsigned_integer<typename A::storage_type>
+                && is_unsigned_integer<typename B::storage_type>;
+
+            // Integral bits including a sign bit, which unsigned
+            // formats have to gain to be mixed with signed ones
+            static constexpr std::size_t ASignedBits = A::IntegralBits + (is_unsigned_integer<typename A::storage_type> ? 1 : 0);
+            static constexpr std::size_t BSignedBits = B::IntegralBits + (is_unsigned_integer<typename B::storage_type> ? 1 : 0);
+
+            // a * b is exact with the fractional bits of both
+            // operands and the sum of their widths
+            static constexpr std::size_t ProductFracBits = A::FracBits + B::FracBits;
+            static constexpr std::size_t ProductBits = A::TotalBits + B::TotalBits;
+
+            // a + b needs the finer of the two fractions and one more
+            // integral bit than the larger of the two. A difference
+            // may be negative even when both operands are unsigned.
+            static constexpr std::size_t SumFracBits = std::max<std::size_t>(A::FracBits, B::FracBits);
+            static constexpr std::size_t UnsignedSumBits = SumFracBits + std::max(A::IntegralBits, B::IntegralBits) + 1;
+            static constexpr std::size_t SignedSumBits = SumFracBits + std::max(ASignedBits, BSignedBits) + 1;
+
+            using product_storage = std::conditional_t<Unsigned, uint_of_bits_t<ProductBits>, int_of_bits_t<ProductBits>>;
+            using sum_storage = std::conditional_t<Unsigned, uint_of_bits_t<UnsignedSumBits>, int_of_bits_t<SignedSumBits>>;
+            using difference_storage = int_of_bits_t<SignedSumBits>;
+
+            using product = fixed<ProductFracBits, product_storage, product_storage>;
+            using sum = fixed<SumFracBits, sum_storage, sum_storage>;
+            using difference = fixed<SumFracBits, difference_storage, difference_storage>;
+        };
+    }
+
+    // Exact result formats of mixed-format arithmetic. No bits are
+    // lost until the result is explicitly converted to a narrower
+    // format, which costs a single shift.
+    template<is_fixed A, is_fixed B>
+    using product_t = typename detail::mixed_format<A, B>::product;
+
+    template<is_fixed A, is_fixed B>
+    using sum_t = typename detail::mixed_format<A, B>::sum;
+
+    template<is_fixed A, is_fixed B>
+    using difference_t = typename detail::mixed_format<A, B>::difference;
+
+    template<is_fixed A, is_fixed B>
+    requires (!std::same_as<A, B>)
+    static constexpr product_t<A, B> operator*(const A& a, const B& b) {
+        using Storage = typename product_t<A, B>::storage_type;
+        return product_t<A, B>::from_raw(static_cast<Storage>(a.raw) * static_cast<Storage>(b.raw));
+    }
+
+    template<is_fixed A, is_fixed B>
+    requires (!std::same_as<A, B>)
+    static constexpr sum_t<A, B> operator+(const A& a, const B& b) {
+        using R = sum_t<A, B>;
+        using Storage = typename R::storage_type;
+
+        return R::from_raw(static_cast<Storage>(static_cast<Storage>(a.raw) << (R::FracBits - A::FracBits))
+                           + static_cast<Storage>(static_cast<Storage>(b.raw) << (R::FracBits - B::FracBits)));
+    }
+
+    template<is_fixed A, is_fixed B>
+    requires (!std::same_as<A, B>)
+    static constexpr difference_t<A, B> operator-(const A& a, const B& b) {
+        using R = difference_t<A, B>;
+        using Storage = typename R::storage_type;
+
+        return R::from_raw(static_cast<Storage>(static_cast<Storage>(a.raw) << (R::FracBits - A::FracBits))
+                           - static_cast<Storage>(static_cast<Storage>(b.raw) << (R::FracBits - B::FracBits)));
+    }
+
+    // Conversion to another format, e.g. from UQ8.8 to Q8.8, that
+    // clamps values outside the range of To instead of wrapping.
+    // Dropped fractional bits are truncated like in operator*.
+    template<is_fixed To, is_fixed From>
+    requires (sizeof(typename To::storage_type) <= 8 && sizeof(typename From::storage_type) <= 8)
+    static constexpr To saturate_cast(const From& x) {
+        using Storage = typename To::storage_type;
+
+        constexpr std::size_t ToFracBits = To::FracBits;
+        constexpr std::size_t FromFracBits = From::FracBits;
+
+        constexpr __int128 Lo = std::numeric_limits<Storage>::min();
+        constexpr __int128 Hi = std::numeric_limits<Storage>::max();
+
+        __int128 value = x.raw;
+
+        if constexpr (FromFracBits > ToFracBits) {
+            value >>= FromFracBits - ToFracBits;
+        } else {
+            // Clamp before shifting so the shift cannot overflow
+            constexpr std::size_t Shift = ToFracBits - FromFracBits;
+
+            if (value > (Hi >> Shift)) {
+                return To::from_raw(std::numeric_limits<Storage>::max());
+            } else if (value < (Lo >> Shift)) {
+                return To::from_raw(std::numeric_limits<Storage>::min());
+            }
+
+            value <<= Shift;
+        }
+
+        return To::from_raw(static_cast<Storage>(std::clamp(value, Lo, Hi)));
+    }
+
     template<is_fixed T>
     constexpr typename T::storage_type truncate(const T& a) {
         return a.raw / T::Scale;
@@ -283,8 +824,9 @@ namespace fixp {
         std::stringstream ss;
         fixed_aux value = fixed_aux::from_raw(static_cast<Intermediate>(x.raw));
 
-        // integral part
-        ss << truncate(value);
+        // integral part, which always fits 64 bits even when the
+        // intermediate is __int128
+        ss << static_cast<std::intmax_t>(truncate(value));
         value -= fixed_aux(truncate(value));
 
         if (!(value.raw & T::FracMask)) {
@@ -294,7 +836,7 @@ namespace fixp {
 
         static constexpr std::size_t max_digits = ([]() constexpr {
             std::size_t log = 0;
-            std::size_t n = 1 << (T::FracBits - 1);
+            std::uintmax_t n = std::uintmax_t { 1 } << (T::FracBits - 1);
 
             while (n) {
                 n /= 10;
@@ -313,7 +855,7 @@ namespace fixp {
         std::size_t i = 0;
         while ((value.raw & T::FracMask) && i < max_digits) {
             value.raw *= 10;
-            ss << truncate(value) % 10;
+            ss << static_cast<int>(truncate(value) % 10);
             value -= fixed_aux(truncate(value));
 
             i++;
@@ -344,7 +886,7 @@ namespace fixp {
             pos++;
         }
 
-        std::size_t integral = detail::math::abs_cexpr(truncate(value));
+        std::size_t integral = static_cast<std::size_t>(detail::math::abs_cexpr(truncate(value)));
         std::size_t pos_tmp = pos;
 
         // this the integral into the string in the reverse order of
@@ -378,7 +920,7 @@ namespace fixp {
 
         static constexpr std::size_t max_digits = ([]() constexpr {
             std::size_t log = 0;
-            std::size_t n = 1 << (T::FracBits - 1);
+            std::uintmax_t n = std::uintmax_t { 1 } << (T::FracBits - 1);
 
             while (n) {
                 n /= 10;
@@ -412,6 +954,34 @@ namespace fixp {
         str[pos] = '\0';
     }
     
+    namespace detail {
+        // Taylor-like approximations on [0, pi/2] using coefficients
+        // stolen from here:
+        // http://www.sahraid.com/FFT/FixedPointArithmatic
+        using sin_poly = poly<0.0, 1.0, 0.0, -0.16605, 0.0, 0.00761>;
+        using cos_poly = poly<1.0, 0.0, -0.49670, 0.0, 0.03705>;
+
+        template<is_fixed T>
+        static constexpr T
+        sin_quadrant(const T& value, typename T::storage_type quadrant) {
+            const T result = sin_poly::evaluate(value);
+            const T sign = quadrant < 2 ? 1.0f : -1.0f;
+
+            return sign * result;
+        }
+
+        template<is_fixed T>
+        static constexpr T
+        cos_quadrant(const T& value, typename T::storage_type quadrant) {
+            const bool is_positive = quadrant == 0 || quadrant == 3;
+            const T sign = is_positive ? 1.0f : -1.0f;
+
+            const T result = cos_poly::evaluate(value);
+
+            return sign * result;
+        }
+    }
+
     template<is_fixed T>
     static constexpr T sin(const T& x) {
         const bool is_negative = x < T::from_raw(0);
@@ -449,7 +1019,7 @@ namespace fixp {
         static constexpr auto SQRT_LUT {[]() constexpr {
             constexpr std::size_t NElements = std::min(
                 static_cast<std::size_t>(LutLimit),
-                static_cast<std::size_t>(1 << T::IntegralBits));
+                detail::math::pow2_saturate(T::IntegralBits));
 
             std::array<fixed_aux, NElements> entries = { };
 
@@ -471,7 +1041,7 @@ namespace fixp {
         // only include bounds checking if the space of the
         // integer part of our value is too large to fit in
         // the LUT
-        if constexpr ((1 << T::IntegralBits) >= LutLimit) {
+        if constexpr (detail::math::pow2_saturate(T::IntegralBits) >= LutLimit) {
             if (truncated < SQRT_LUT.size()) {
                 x = SQRT_LUT[truncated];
             } else {
@@ -797,6 +1367,80 @@ namespace fixp {
     //         }
     // };
 
+    template<const std::size_t FractionalBits,
+             is_integer Storage,
+             is_integer Intermediate>
+    requires (sizeof(Storage) * 8 - (is_signed_integer<Storage> ? 1 : 0) >= FractionalBits
+              && sizeof(Intermediate) >= sizeof(Storage)
+              && is_signed_integer<Storage> == is_signed_integer<Intermediate>)
+    consteval fixed<FractionalBits, Storage, Intermediate>
+    fixed<FractionalBits, Storage, Intermediate>::from_ratio(std::intmax_t num, std::intmax_t den) {
+        if (den == 0) {
+            detail::invalid_fixed_literal();
+        }
+
+        const __int128 scaled = static_cast<__int128>(num) << FractionalBits;
+        __int128 quotient = scaled / den;
+        const __int128 remainder = scaled % den;
+
+        const __int128 abs_remainder = remainder < 0 ? -remainder : remainder;
+        const __int128 abs_den = den < 0 ? -static_cast<__int128>(den) : den;
+
+        if (2 * abs_remainder >= abs_den) {
+            quotient += (scaled < 0) != (den < 0) ? -1 : 1;
+        }
+
+        if (quotient > std::numeric_limits<Storage>::max() || quotient < std::numeric_limits<Storage>::min()) {
+            detail::invalid_fixed_literal();
+        }
+
+        return from_raw(static_cast<Storage>(quotient));
+    }
+
+    // Exact compile time literals, e.g. 1.5_q16 or 0.70710678_q15.
+    // Any format can get its own with
+    //
+    //     template<char... Cs>
+    //     consteval my_fixed operator""_my() {
+    //         return fixp::literal<my_fixed, Cs...>();
+    //     }
+    template<is_fixed T, char... Cs>
+    consteval T literal() {
+        return detail::parse_decimal<T>(detail::LiteralChars<Cs...>.chars);
+    }
+
+    namespace literals {
+        // Q0.15
+        template<char... Cs>
+        consteval fixed<15, std::int16_t, std::int32_t> operator""_q15() {
+            return literal<fixed<15, std::int16_t, std::int32_t>, Cs...>();
+        }
+
+        // Q4.12
+        template<char... Cs>
+        consteval fixed<12, std::int16_t, std::int32_t> operator""_q12() {
+            return literal<fixed<12, std::int16_t, std::int32_t>, Cs...>();
+        }
+
+        // Q8.8
+        template<char... Cs>
+        consteval fixed<8, std::int16_t, std::int32_t> operator""_q8() {
+            return literal<fixed<8, std::int16_t, std::int32_t>, Cs...>();
+        }
+
+        // Q16.16
+        template<char... Cs>
+        consteval fixed<16, std::int32_t, std::int64_t> operator""_q16() {
+            return literal<fixed<16, std::int32_t, std::int64_t>, Cs...>();
+        }
+
+        // Q32.32
+        template<char... Cs>
+        consteval fixed<32, std::int64_t, __int128> operator""_q32() {
+            return literal<fixed<32, std::int64_t, __int128>, Cs...>();
+        }
+    }
+
     template<is_fixed T, const std::size_t Dim>
     class packed final {
         private:
@@ -19,20 +19,13 @@
  * THE SOFTWARE.
  */
 
-#include <array>
-#include <initializer_list>
+#pragma once
 
-#ifdef 
-#ifdef __ARM_NEON
-#endif
+#include <array>
+#include <concepts>
+#include <cstddef>
 
 namespace fixp {
-    namespace detail {
-        namespace neon {
-            
-        }
-    }
-    
     namespace linalg {
         template<typename T>
         concept is_numeric = requires(T a, T b) {
@@ -41,22 +34,83 @@ namespace fixp {
             { a * b } -> std::same_as<T>;
             { a / b } -> std::same_as<T>;
         };
-        
-        template<typename T, const std::size_t N>
+
+        template<is_numeric T, const std::size_t N>
+        requires (N > 0)
         class vec {
             private:
-                std::array<T, N> elements;
+                std::array<T, N> elements {};
 
-                static constexpr std::size_t MemberSize = sizeof(T);
-                
             public:
-                constexpr vec(std::initializer_list<T> values) {
-                    static_assert(values.size() == N);
+                using value_type = T;
+                static constexpr std::size_t Dimensions = N;
+
+                constexpr vec() = default;
+
+                template<std::convertible_to<T>... Ts>
+                requires (sizeof...(Ts) == N)
+                constexpr vec(const Ts&... values) : elements { static_cast<T>(values)... } {}
+
+                constexpr T& operator[](std::size_t i) { return elements[i]; }
+                constexpr const T& operator[](std::size_t i) const { return elements[i]; }
+
+                constexpr vec& operator+=(const vec& other) {
+                    for (std::size_t i = 0; i < N; i++) {
+                        elements[i] = elements[i] + other.elements[i];
+                    }
+
+                    return *this;
+                }
+
+                constexpr vec& operator-=(const vec& other) {
+                    for (std::size_t i = 0; i < N; i++) {
+                        elements[i] = elements[i] - other.elements[i];
+                    }
+
+                    return *this;
+                }
+
+                constexpr vec& operator*=(const T& k) {
+                    for (std::size_t i = 0; i < N; i++) {
+                        elements[i] = elements[i] * k;
+                    }
+
+                    return *this;
                 }
 
-                vec<T, N> operator+(const vec& other) {
-                    
+                friend constexpr vec operator+(vec a, const vec& b) { return a += b; }
+                friend constexpr vec operator-(vec a, const vec& b) { return a -= b; }
+                friend constexpr vec operator*(vec a, const T& k) { return a *= k; }
+                friend constexpr vec operator*(const T& k, vec a) { return a *= k; }
+
+                friend constexpr bool operator==(const vec& a, const vec& b) {
+                    for (std::size_t i = 0; i < N; i++) {
+                        if (!(a.elements[i] == b.elements[i])) {
+                            return false;
+                        }
+                    }
+
+                    return true;
                 }
         };
+
+        template<is_numeric T, const std::size_t N>
+        constexpr T dot(const vec<T, N>& a, const vec<T, N>& b) {
+            T sum = a[0] * b[0];
+            for (std::size_t i = 1; i < N; i++) {
+                sum = sum + a[i] * b[i];
+            }
+
+            return sum;
+        }
+
+        template<is_numeric T>
+        using vec2 = vec<T, 2>;
+
+        template<is_numeric T>
+        using vec3 = vec<T, 3>;
+
+        template<is_numeric T>
+        using vec4 = vec<T, 4>;
     }
 }
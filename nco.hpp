@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <complex.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <fixp.hpp>
+#include <limits>
+#include <numbers>
+
+namespace fixp::dsp {
+    enum class nco_lookup {
+        // Nearest table entry (rounded, or dithered and truncated),
+        // one load per sample
+        nearest,
+        // Linear interpolation between neighbouring entries
+        interpolated,
+    };
+
+    namespace detail {
+        // One full period of sin in T, plus a guard entry so that
+        // interpolation never needs to wrap
+        template<is_fixed T, const std::size_t TableBits>
+        static constexpr auto SineTable = ([]() constexpr {
+            using Storage = typename T::storage_type;
+
+            constexpr std::size_t Size = std::size_t { 1 } << TableBits;
+            constexpr double Scale = static_cast<double>(std::int64_t { 1 } << T::FracBits);
+            constexpr double Max = static_cast<double>(std::numeric_limits<Storage>::max());
+
+            std::array<Storage, Size + 1> table = { };
+
+            for (std::size_t i = 0; i <= Size; i++) {
+                const double angle = 2.0 * std::numbers::pi_v<double> * static_cast<double>(i) / static_cast<double>(Size);
+                const double value = fixp::detail::math::sin_cexpr(angle) * Scale;
+
+                // e.g. Q0.15 cannot represent 1.0
+                table[i] = fixp::detail::math::round_cexpr<Storage>(std::clamp(value, -Max, Max));
+            }
+
+            return table;
+        })();
+    }
+
+    // Numerically controlled oscillator for Channels independent
+    // carriers. The phase of each channel is a 32-bit binary angle
+    // (2^32 == one turn) advanced by a per-channel increment, so the
+    // phase wraps for free and a sample costs one add plus a table
+    // lookup. Blocks are interleaved (out[frame * Channels + channel])
+    // and the per-frame loop runs across channels in SIMD lanes.
+    //
+    // Dithering adds one LSB of pseudo-random noise to the phase
+    // before it is truncated, which turns the phase truncation spurs
+    // into a noise floor.
+    template<is_fixed T,
+             const std::size_t Channels = 1,
+             const std::size_t TableBits = 10,
+             const nco_lookup Lookup = nco_lookup::interpolated,
+             const bool Dither = false>
+    requires (Channels > 0 && TableBits >= 2 && TableBits <= 16
+              && (Lookup == nco_lookup::nearest
+                  || sizeof(typename T::intermediate_type) > sizeof(typename T::storage_type)))
+    class nco final {
+        public:
+            using value_type = T;
+            using phase_type = std::uint32_t;
+
+            // A quarter turn, cos(x) = sin(x + QuarterTurn)
+            static constexpr phase_type QuarterTurn = phase_type { 1 } << 30;
+
+        private:
+            using Storage = typename T::storage_type;
+            using Intermediate = typename T::intermediate_type;
+
+            static constexpr int IndexShift = 32 - TableBits;
+            // Keeps (b - a) * frac within the intermediate type, which
+            // interpolation needs to be wider than the storage
+            static constexpr int LerpBits = Lookup == nco_lookup::nearest
+                ? 0
+                : std::min<int>(IndexShift, (sizeof(Intermediate) - sizeof(Storage)) * 8 - 2);
+            static constexpr phase_type LerpMask = (phase_type { 1 } << LerpBits) - 1;
+            static constexpr int DitherBits = Lookup == nco_lookup::nearest ? IndexShift : IndexShift - LerpBits;
+
+            static constexpr const auto& Table = detail::SineTable<T, TableBits>;
+
+            std::array<phase_type, Channels> phase;
+            std::array<phase_type, Channels> increment;
+            std::array<std::uint32_t, Channels> noise;
+
+            FIXP_ALWAYS_INLINE inline phase_type
+            dither(std::size_t ch) {
+                // xorshift32
+                std::uint32_t x = noise[ch];
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                noise[ch] = x;
+
+                if constexpr (DitherBits > 0) {
+                    return x >> (32 - DitherBits);
+                } else {
+                    return 0;
+                }
+            }
+
+            FIXP_ALWAYS_INLINE static inline Storage
+            lookup(phase_type p) {
+                if constexpr (Lookup == nco_lookup::nearest) {
+                    // Dither spread evenly over one entry and then
+                    // truncated already averages out to p. Otherwise
+                    // round, using the guard entry past the last one.
+                    constexpr std::uint64_t Half = Dither ? 0 : std::uint64_t { 1 } << (IndexShift - 1);
+
+                    return Table[static_cast<std::size_t>((p + Half) >> IndexShift)];
+                } else {
+                    const std::size_t index = p >> IndexShift;
+                    const Intermediate frac = static_cast<Intermediate>((p >> (IndexShift - LerpBits)) & LerpMask);
+                    const Intermediate a = Table[index];
+                    const Intermediate b = Table[index + 1];
+
+                    return static_cast<Storage>(a + (((b - a) * frac) >> LerpBits));
+                }
+            }
+
+        public:
+            constexpr nco() {
+                phase.fill(0);
+                increment.fill(0);
+
+                for (std::size_t ch = 0; ch < Channels; ch++) {
+                    noise[ch] = 0x9e3779b9u ^ static_cast<std::uint32_t>(ch * 0x85ebca6bu);
+                }
+            }
+
+            // Phase increment for a frequency given as a fraction of
+            // the sample rate, e.g. 0.25 for fs / 4
+            static constexpr phase_type
+            increment_for(double cycles_per_sample) {
+                const double turns = cycles_per_sample - static_cast<double>(static_cast<std::int64_t>(cycles_per_sample));
+                const double wrapped = turns < 0.0 ? turns + 1.0 : turns;
+
+                return static_cast<phase_type>(static_cast<std::uint64_t>(wrapped * 4294967296.0 + 0.5));
+            }
+
+            constexpr void set_increment(std::size_t ch, phase_type inc) { increment[ch] = inc; }
+            constexpr void set_frequency(std::size_t ch, double cycles_per_sample) { increment[ch] = increment_for(cycles_per_sample); }
+            constexpr void set_phase(std::size_t ch, phase_type p) { phase[ch] = p; }
+
+            constexpr phase_type get_phase(std::size_t ch) const { return phase[ch]; }
+            constexpr phase_type get_increment(std::size_t ch) const { return increment[ch]; }
+
+            // sin of each channel's phase, frames * Channels values
+            void generate(T* out, std::size_t frames) {
+                for (std::size_t n = 0; n < frames; n++) {
+                    T* frame = &out[n * Channels];
+
+                    #pragma omp simd
+                    for (std::size_t ch = 0; ch < Channels; ch++) {
+                        phase_type p = phase[ch];
+                        if constexpr (Dither) {
+                            p += dither(ch);
+                        }
+
+                        frame[ch] = T::from_raw(lookup(p));
+                        phase[ch] += increment[ch];
+                    }
+                }
+            }
+
+            // Quadrature output, e^(j phase) = cos + j sin
+            void generate(complex<T>* out, std::size_t frames) {
+                for (std::size_t n = 0; n < frames; n++) {
+                    complex<T>* frame = &out[n * Channels];
+
+                    #pragma omp simd
+                    for (std::size_t ch = 0; ch < Channels; ch++) {
+                        phase_type p = phase[ch];
+                        if constexpr (Dither) {
+                            p += dither(ch);
+                        }
+
+                        frame[ch] = { T::from_raw(lookup(p + QuarterTurn)), T::from_raw(lookup(p)) };
+                        phase[ch] += increment[ch];
+                    }
+                }
+            }
+    };
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include <bulk.hpp>
+#include <divider.hpp>
+#include <fir.hpp>
+#include <fixp.hpp>
+
+// Multithreaded (OpenMP) versions of the bulk kernels, for arrays large
+// enough to be worth spreading across cores, e.g.
+//
+//   fixp::parallel::fma(a, b, c, out, n);
+//
+// Work is cut into chunks of a fixed number of bytes, a multiple of the
+// cache line size, so no two threads write to the same line. The chunks
+// do not depend on the number of threads, and reductions add up one
+// partial result per chunk in chunk order, so every result is the same
+// bit for bit whatever OMP_NUM_THREADS is. Arrays of a single chunk run
+// on the calling thread.
+//
+// Chunks go to OpenMP threads by default. Every function takes an
+// executor as its last argument to change that, e.g. a fixp::task_pool
+// (pool.hpp) shared with other jobs. An executor is anything with a
+// for_each(count, f) that calls f(0) ... f(count - 1) and returns once
+// they are done.
+namespace fixp {
+    namespace parallel {
+        // Static OpenMP split, one run of chunks per thread
+        struct openmp {
+            template<typename F>
+            void for_each(std::size_t count, const F& f) const {
+                #pragma omp parallel for schedule(static) if(count > 1)
+                for (std::size_t i = 0; i < count; i++) {
+                    f(i);
+                }
+            }
+        };
+
+        template<typename E>
+        concept executor = requires(E& e, void (*f)(std::size_t)) { e.for_each(std::size_t { 0 }, f); };
+    }
+
+    namespace detail::parallel {
+        static constexpr std::size_t ChunkBytes = 16384;
+
+        template<typename T>
+        static constexpr std::size_t Grain = std::max<std::size_t>(ChunkBytes / sizeof(T), 1);
+
+        // f(begin, count) for every chunk of [0, n)
+        template<typename T, typename F, fixp::parallel::executor Executor>
+        static inline void
+        for_chunks(std::size_t n, const F& f, Executor& executor) {
+            executor.for_each((n + Grain<T> - 1) / Grain<T>, [&](std::size_t c) {
+                const std::size_t begin = c * Grain<T>;
+                f(begin, std::min(Grain<T>, n - begin));
+            });
+        }
+
+        // partial(begin, count) for every chunk, added up in order
+        template<typename T, typename R, typename F, fixp::parallel::executor Executor>
+        static inline R
+        reduce(std::size_t n, const F& partial, Executor& executor) {
+            std::vector<R> partials((n + Grain<T> - 1) / Grain<T>);
+
+            for_chunks<T>(n, [&](std::size_t begin, std::size_t count) {
+                partials[begin / Grain<T>] = partial(begin, count);
+            }, executor);
+
+            R total = 0;
+            for (const R& p : partials) {
+                total += p;
+            }
+
+            return total;
+        }
+    }
+
+    namespace parallel {
+        template<is_fixed T, executor Executor = openmp>
+        static inline void
+        add_saturate(const T* a, const T* b, T* out, std::size_t n, Executor&& executor = Executor {}) {
+            detail::parallel::for_chunks<T>(n, [=](std::size_t i, std::size_t m) {
+                fixp::add_saturate(a + i, b + i, out + i, m);
+            }, executor);
+        }
+
+        template<is_fixed T, executor Executor = openmp>
+        static inline void
+        sub_saturate(const T* a, const T* b, T* out, std::size_t n, Executor&& executor = Executor {}) {
+            detail::parallel::for_chunks<T>(n, [=](std::size_t i, std::size_t m) {
+                fixp::sub_saturate(a + i, b + i, out + i, m);
+            }, executor);
+        }
+
+        template<rounding Rounding = rounding::nearest,
+                 overflow Overflow = overflow::saturate,
+                 std::floating_point F,
+                 is_fixed T,
+                 executor Executor = openmp>
+        static inline void
+        from_float(const F* in, T* out, std::size_t n, Executor&& executor = Executor {}) {
+            detail::parallel::for_chunks<T>(n, [=](std::size_t i, std::size_t m) {
+                fixp::from_float<Rounding, Overflow>(in + i, out + i, m);
+            }, executor);
+        }
+
+        template<is_fixed T, std::floating_point F, executor Executor = openmp>
+        static inline void
+        to_float(const T* in, F* out, std::size_t n, Executor&& executor = Executor {}) {
+            detail::parallel::for_chunks<T>(n, [=](std::size_t i, std::size_t m) {
+                fixp::to_float(in + i, out + i, m);
+            }, executor);
+        }
+
+        template<overflow Overflow = overflow::saturate, is_fixed From, is_fixed To, executor Executor = openmp>
+        static inline void
+        convert(const From* in, To* out, std::size_t n, Executor&& executor = Executor {}) {
+            detail::parallel::for_chunks<To>(n, [=](std::size_t i, std::size_t m) {
+                fixp::convert<Overflow>(in + i, out + i, m);
+            }, executor);
+        }
+
+        template<rounding Rounding = rounding::nearest, is_fixed T, executor Executor = openmp>
+        static inline void
+        fma(const T* a, const T* b, const T* c, T* out, std::size_t n, Executor&& executor = Executor {}) {
+            detail::parallel::for_chunks<T>(n, [=](std::size_t i, std::size_t m) {
+                fixp::fma<Rounding>(a + i, b + i, c + i, out + i, m);
+            }, executor);
+        }
+
+        template<rounding Rounding = rounding::nearest, is_fixed T, executor Executor = openmp>
+        static inline void
+        fma(const T* a, const T& b, const T* c, T* out, std::size_t n, Executor&& executor = Executor {}) {
+            detail::parallel::for_chunks<T>(n, [=, &b](std::size_t i, std::size_t m) {
+                fixp::fma<Rounding>(a + i, b, c + i, out + i, m);
+            }, executor);
+        }
+
+        template<typename Poly,
+                 poly_scheme Scheme = poly_scheme::horner,
+                 rounding Rounding = rounding::nearest,
+                 is_fixed T,
+                 executor Executor = openmp>
+        static inline void
+        evaluate(const T* in, T* out, std::size_t n, Executor&& executor = Executor {}) {
+            detail::parallel::for_chunks<T>(n, [=](std::size_t i, std::size_t m) {
+                fixp::evaluate<Poly, Scheme, Rounding>(in + i, out + i, m);
+            }, executor);
+        }
+
+        template<division_accuracy Accuracy = division_accuracy::exact, is_fixed T, executor Executor = openmp>
+        static inline void
+        div(const T* a, const T* b, T* out, std::size_t n, Executor&& executor = Executor {}) {
+            detail::parallel::for_chunks<T>(n, [=](std::size_t i, std::size_t m) {
+                fixp::div<Accuracy>(a + i, b + i, out + i, m);
+            }, executor);
+        }
+
+        template<division_accuracy Accuracy = division_accuracy::exact, is_fixed T, executor Executor = openmp>
+        static inline void
+        reciprocal(const T* in, T* out, std::size_t n, Executor&& executor = Executor {}) {
+            detail::parallel::for_chunks<T>(n, [=](std::size_t i, std::size_t m) {
+                fixp::reciprocal<Accuracy>(in + i, out + i, m);
+            }, executor);
+        }
+
+        // out[i] = f(in[i]) for any elementwise function, e.g. the
+        // transcendentals:
+        //
+        //   fixp::parallel::transform(x, y, n, [](auto v) { return fixp::sin(v); });
+        //
+        // f is called from several threads at once, in order within
+        // each chunk, so any side effects it has must be thread safe.
+        template<is_fixed T, typename U, typename F, executor Executor = openmp>
+        requires std::convertible_to<std::invoke_result_t<const F&, const T&>, U>
+        static inline void
+        transform(const T* in, U* out, std::size_t n, const F& f, Executor&& executor = Executor {}) {
+            detail::parallel::for_chunks<T>(n, [=, &f](std::size_t i, std::size_t m) {
+                for (std::size_t j = i; j < i + m; j++) {
+                    out[j] = f(in[j]);
+                }
+            }, executor);
+        }
+
+        // Sum of in[0..n), exact as long as it fits in Accumulator (by
+        // default at least 64 bits, see accumulator_t)
+        template<is_fixed T, is_integer Accumulator = accumulator_t<T>, executor Executor = openmp>
+        static inline fixed<T::FracBits, Accumulator, Accumulator>
+        sum(const T* in, std::size_t n, Executor&& executor = Executor {}) {
+            using R = fixed<T::FracBits, Accumulator, Accumulator>;
+
+            return R::from_raw(detail::parallel::reduce<T, Accumulator>(n, [=](std::size_t i, std::size_t m) {
+                Accumulator s = 0;
+
+                #pragma omp simd reduction(+:s)
+                for (std::size_t j = i; j < i + m; j++) {
+                    s += static_cast<Accumulator>(in[j].raw);
+                }
+
+                return s;
+            }, executor));
+        }
+
+        // Sum of a[i] * b[i], accumulated at full precision and rounded
+        // to T once at the end, like the FIR filters
+        template<is_fixed T, is_signed_integer Accumulator = accumulator_t<T>, executor Executor = openmp>
+        requires is_signed_integer<typename T::storage_type>
+        static inline T
+        dot(const T* a, const T* b, std::size_t n, Executor&& executor = Executor {}) {
+            return dsp::detail::narrow<T>(detail::parallel::reduce<T, Accumulator>(n, [=](std::size_t i, std::size_t m) {
+                return dsp::detail::dot<Accumulator>(&a[i].raw, &b[i].raw, m);
+            }, executor));
+        }
+    }
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <aligned.hpp>
+#include <fixp.hpp>
+
+// Runs a chain of kernels over a large array a chunk at a time, so
+// that the intermediate results stay in cache instead of every stage
+// streaming the whole array through memory. A stage is anything taking
+// (const T* in, T* out, std::size_t n), which covers the bulk.hpp
+// kernels (through a lambda) and the process() of fir, biquad_cascade
+// and friends:
+//
+//   fixp::dsp::fir<fixed_q4_12, 16> filter(coefficients);
+//   fixp::pipeline<fixed_q4_12> p;
+//   p.then(filter)
+//    .then([](const auto* in, auto* out, std::size_t n) { fixp::evaluate<gain>(in, out, n); });
+//   p.run(in, out, n);
+//
+// run_threaded() gives each stage a thread of its own, connected by
+// bounded queues, so that the stages overlap across cores. Chunks go
+// through every stage in order either way, so stateful stages see the
+// same stream as they would on their own.
+namespace fixp {
+    namespace detail::pipeline {
+        // Bounded single producer, single consumer queue. Pushing and
+        // popping are lock free; a thread only blocks (on the index it
+        // is waiting for) when the queue is full or empty.
+        template<typename T, std::size_t Capacity>
+        requires (Capacity > 0 && (Capacity & (Capacity - 1)) == 0)
+        class spsc_queue final {
+            private:
+                std::array<T, Capacity> slots;
+
+                // On separate cache lines, so that the two threads do
+                // not fight over one
+                alignas(DefaultAlignment) std::atomic<std::size_t> head = 0;
+                alignas(DefaultAlignment) std::atomic<std::size_t> tail = 0;
+
+            public:
+                void push(const T& value) {
+                    const std::size_t t = tail.load(std::memory_order_relaxed);
+
+                    for (std::size_t h; t - (h = head.load(std::memory_order_acquire)) == Capacity;) {
+                        head.wait(h, std::memory_order_acquire);
+                    }
+
+                    slots[t % Capacity] = value;
+                    tail.store(t + 1, std::memory_order_release);
+                    tail.notify_one();
+                }
+
+                T pop() {
+                    const std::size_t h = head.load(std::memory_order_relaxed);
+
+                    for (std::size_t t; (t = tail.load(std::memory_order_acquire)) == h;) {
+                        tail.wait(t, std::memory_order_acquire);
+                    }
+
+                    T value = slots[h % Capacity];
+                    head.store(h + 1, std::memory_order_release);
+                    head.notify_one();
+
+                    return value;
+                }
+        };
+
+        // A chunk in flight. Stages read a and write b, then the two are
+        // swapped for the next stage. The first stage reads the input
+        // and the last writes the output directly.
+        template<typename T>
+        struct chunk {
+            T* a;
+            T* b;
+            std::size_t offset;
+            std::size_t n;
+        };
+    }
+
+    // Chunk size, in bytes, that keeps a chunk and its scratch buffer
+    // well inside L2
+    static constexpr std::size_t DefaultChunkBytes = 16384;
+
+    template<is_fixed T>
+    class pipeline final {
+        public:
+            using value_type = T;
+            using stage = std::function<void(const T*, T*, std::size_t)>;
+
+        private:
+            // Chunks in flight at once in run_threaded()
+            static constexpr std::size_t InFlight = 4;
+
+            using chunk = detail::pipeline::chunk<T>;
+            using queue = detail::pipeline::spsc_queue<chunk, 8>;
+
+            std::vector<stage> stages;
+            std::size_t chunk_size;
+            std::vector<T, aligned_allocator<T>> buffers;
+
+            // Runs stage s over one chunk
+            void run_stage(std::size_t s, chunk& c, const T* in, T* out) {
+                const T* src = s == 0 ? in + c.offset : c.a;
+                T* dst = s + 1 == stages.size() ? out + c.offset : c.b;
+
+                stages[s](src, dst, c.n);
+                std::swap(c.a, c.b);
+            }
+
+        public:
+            // chunk_size is in values, rounded up to a whole number of
+            // cache lines
+            explicit pipeline(std::size_t chunk_size = DefaultChunkBytes / sizeof(T))
+                : chunk_size(padded_size<T>(std::max<std::size_t>(chunk_size, 1))) {}
+
+            pipeline& then(stage s) {
+                stages.push_back(std::move(s));
+                return *this;
+            }
+
+            // Adds a filter (or anything else with a block process()) by
+            // reference, so its state carries over between runs
+            template<typename Processor>
+            requires requires(Processor& p, const T* in, T* out, std::size_t n) { p.process(in, out, n); }
+            pipeline& then(Processor& processor) {
+                return then([&processor](const T* in, T* out, std::size_t n) { processor.process(in, out, n); });
+            }
+
+            std::size_t size() const { return stages.size(); }
+
+            std::size_t chunk_values() const { return chunk_size; }
+
+            // out[0..n) = every stage applied in turn to in[0..n), on the
+            // calling thread. With more than one stage, in and out may
+            // be the same array.
+            void run(const T* in, T* out, std::size_t n) {
+                if (stages.empty()) {
+                    std::copy(in, in + n, out);
+                    return;
+                }
+
+                buffers.resize(2 * chunk_size);
+
+                for (std::size_t offset = 0; offset < n; offset += chunk_size) {
+                    chunk c { buffers.data(), buffers.data() + chunk_size, offset, std::min(chunk_size, n - offset) };
+
+                    for (std::size_t s = 0; s < stages.size(); s++) {
+                        run_stage(s, c, in, out);
+                    }
+                }
+            }
+
+            // As run(), with a thread per stage. Stages must not throw
+            // and must not share state with each other, since they run
+            // concurrently (on different chunks).
+            void run_threaded(const T* in, T* out, std::size_t n) {
+                if (stages.size() < 2) {
+                    run(in, out, n);
+                    return;
+                }
+
+                buffers.resize(2 * chunk_size * InFlight);
+
+                // links[s] feeds stage s, and the last stage hands chunks
+                // back to the first through links[0]
+                std::vector<queue> links(stages.size());
+
+                for (std::size_t i = 0; i < InFlight; i++) {
+                    T* a = buffers.data() + 2 * i * chunk_size;
+                    links[0].push(chunk { a, a + chunk_size, 0, 0 });
+                }
+
+                const auto worker = [&](std::size_t s) {
+                    const bool last = s + 1 == stages.size();
+
+                    for (;;) {
+                        chunk c = links[s].pop();
+
+                        // A chunk with nothing in it ends the stream
+                        if (c.n == 0) {
+                            if (!last) {
+                                links[s + 1].push(c);
+                            }
+                            return;
+                        }
+
+                        run_stage(s, c, in, out);
+                        links[last ? 0 : s + 1].push(c);
+                    }
+                };
+
+                std::vector<std::thread> threads;
+                threads.reserve(stages.size() - 1);
+                for (std::size_t s = 1; s < stages.size(); s++) {
+                    threads.emplace_back(worker, s);
+                }
+
+                // The first stage runs here
+                for (std::size_t offset = 0; offset < n; offset += chunk_size) {
+                    chunk c = links[0].pop();
+                    c.offset = offset;
+                    c.n = std::min(chunk_size, n - offset);
+
+                    run_stage(0, c, in, out);
+                    links[1].push(c);
+                }
+
+                chunk end = links[0].pop();
+                end.n = 0;
+                links[1].push(end);
+
+                for (std::thread& t : threads) {
+                    t.join();
+                }
+            }
+    };
+}
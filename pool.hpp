@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A work stealing thread pool, for many jobs of different sizes (FFT
+// frames, filter banks, ...) at once, where a static split leaves cores
+// idle. Every worker has a deque of its own: it pushes and pops tasks
+// at the back, and when it runs out it steals from the front of the
+// others'. Tasks submitted from inside a task go on the deque of the
+// worker running it, so nested work stays local.
+//
+//   fixp::task_pool pool;
+//   fixp::task_pool::group jobs;
+//   for (auto& frame : frames) {
+//       pool.submit(jobs, [&frame] { fft::forward(frame.data()); });
+//   }
+//   pool.wait(jobs);
+//
+// A pool is also an executor for the fixp::parallel kernels:
+//
+//   fixp::parallel::fma(a, b, c, out, n, pool);
+//
+// Threads waiting on a group run queued tasks in the meantime, so
+// waiting inside a task neither deadlocks nor needs extra threads.
+namespace fixp {
+    class task_pool final {
+        public:
+            // Tasks that can be waited on together
+            class group final {
+                friend class task_pool;
+
+                private:
+                    std::mutex lock;
+                    std::condition_variable done;
+                    std::size_t pending = 0;
+
+                    void add() {
+                        const std::lock_guard guard(lock);
+                        pending++;
+                    }
+
+                    void finish() {
+                        // Under the lock, so that a waiter cannot see
+                        // pending reach 0 and destroy the group before
+                        // done has been notified
+                        const std::lock_guard guard(lock);
+                        if (--pending == 0) {
+                            done.notify_all();
+                        }
+                    }
+
+                    bool finished() {
+                        const std::lock_guard guard(lock);
+                        return pending == 0;
+                    }
+            };
+
+        private:
+            struct task {
+                std::move_only_function<void()> run;
+                group* owner = nullptr;
+            };
+
+            struct worker {
+                std::mutex lock;
+                std::deque<task> tasks;
+            };
+
+            std::vector<std::unique_ptr<worker>> workers;
+            std::vector<std::thread> threads;
+
+            // Sleeping workers wait on wake until queued is non zero
+            std::mutex sleep;
+            std::condition_variable wake;
+            std::size_t queued = 0;
+            bool stopping = false;
+
+            // Where submissions from outside the pool go next
+            std::size_t next = 0;
+
+            // The pool and worker the current thread belongs to, if any
+            static inline thread_local const task_pool* current_pool = nullptr;
+            static inline thread_local std::size_t current_worker = 0;
+
+            // Own deque first (newest task, still in cache), then the
+            // oldest task of every other worker in turn
+            bool take(std::size_t self, task& t) {
+                {
+                    worker& w = *workers[self];
+                    const std::lock_guard guard(w.lock);
+
+                    if (!w.tasks.empty()) {
+                        t = std::move(w.tasks.back());
+                        w.tasks.pop_back();
+                        return true;
+                    }
+                }
+
+                for (std::size_t i = 1; i < workers.size(); i++) {
+                    worker& w = *workers[(self + i) % workers.size()];
+                    const std::lock_guard guard(w.lock);
+
+                    if (!w.tasks.empty()) {
+                        t = std::move(w.tasks.front());
+                        w.tasks.pop_front();
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            // Runs one queued task, if there is one
+            bool run_one(std::size_t self) {
+                task t;
+                if (!take(self, t)) {
+                    return false;
+                }
+
+                {
+                    const std::lock_guard guard(sleep);
+                    queued--;
+                }
+
+                t.run();
+                t.owner->finish();
+
+                return true;
+            }
+
+            void work(std::size_t self) {
+                current_pool = this;
+                current_worker = self;
+
+                for (;;) {
+                    if (run_one(self)) {
+                        continue;
+                    }
+
+                    std::unique_lock guard(sleep);
+                    wake.wait(guard, [this] { return queued > 0 || stopping; });
+
+                    if (queued == 0 && stopping) {
+                        return;
+                    }
+                }
+            }
+
+        public:
+            explicit task_pool(std::size_t threads = std::thread::hardware_concurrency()) {
+                threads = std::max<std::size_t>(threads, 1);
+
+                for (std::size_t i = 0; i < threads; i++) {
+                    workers.push_back(std::make_unique<worker>());
+                }
+
+                this->threads.reserve(threads);
+                for (std::size_t i = 0; i < threads; i++) {
+                    this->threads.emplace_back(&task_pool::work, this, i);
+                }
+            }
+
+            task_pool(const task_pool&) = delete;
+            task_pool& operator=(const task_pool&) = delete;
+
+            // Finishes every queued task first
+            ~task_pool() {
+                {
+                    const std::lock_guard guard(sleep);
+                    stopping = true;
+                }
+                wake.notify_all();
+
+                for (std::thread& t : threads) {
+                    t.join();
+                }
+            }
+
+            std::size_t size() const { return workers.size(); }
+
+            template<typename F>
+            void submit(group& g, F&& f) {
+                g.add();
+
+                std::size_t target = current_worker;
+                {
+                    // Counted before the task is published, so the
+                    // thread that takes it cannot drop queued below 0
+                    const std::lock_guard guard(sleep);
+                    queued++;
+
+                    if (current_pool != this) {
+                        target = next++ % workers.size();
+                    }
+                }
+
+                {
+                    worker& w = *workers[target];
+                    const std::lock_guard guard(w.lock);
+                    w.tasks.push_back(task { std::forward<F>(f), &g });
+                }
+                wake.notify_one();
+            }
+
+            // Returns once every task in g has run, running queued
+            // tasks (of any group) in the meantime
+            void wait(group& g) {
+                const std::size_t self = current_pool == this ? current_worker : 0;
+
+                while (!g.finished()) {
+                    if (!run_one(self)) {
+                        // Whatever is left of g is running elsewhere
+                        std::unique_lock guard(g.lock);
+                        g.done.wait(guard, [&g] { return g.pending == 0; });
+                        return;
+                    }
+                }
+            }
+
+            // Executor interface for fixp::parallel: f(0) ... f(count - 1)
+            template<typename F>
+            void for_each(std::size_t count, const F& f) {
+                if (count == 1) {
+                    f(0);
+                    return;
+                }
+
+                group g;
+                for (std::size_t i = 0; i < count; i++) {
+                    submit(g, [&f, i] { f(i); });
+                }
+                wait(g);
+            }
+    };
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <fixp.hpp>
+#include <limits>
+
+namespace fixp {
+    namespace detail::range {
+        // Bits needed to hold v in two's complement
+        static constexpr std::size_t bits_for(std::intmax_t v) {
+            const std::uintmax_t magnitude = v < 0 ? ~static_cast<std::uintmax_t>(v) : static_cast<std::uintmax_t>(v);
+            return std::bit_width(magnitude) + 1;
+        }
+
+        // Bound arithmetic is checked so that a range that no longer
+        // fits 64 bits is a compile error rather than a silent wrap
+        static constexpr std::intmax_t checked(__int128 v) {
+            if (v > std::numeric_limits<std::intmax_t>::max() || v < std::numeric_limits<std::intmax_t>::min()) {
+                fixp::detail::invalid_fixed_literal();
+            }
+
+            return static_cast<std::intmax_t>(v);
+        }
+
+        static constexpr std::intmax_t shl(std::intmax_t v, std::size_t bits) {
+            return checked(static_cast<__int128>(v) * (static_cast<__int128>(1) << bits));
+        }
+    }
+
+    // A fixed point value whose raw value is known at compile time to
+    // lie in [Min, Max], in units of 2^-FracBits. Arithmetic computes
+    // the range of its result, and each value is stored in the
+    // narrowest integer that can hold its range, so expressions are
+    // overflow free by construction and use the densest SIMD lanes
+    // available.
+    template<const std::size_t FractionalBits, const std::intmax_t Min, const std::intmax_t Max>
+    requires (Min <= Max && FractionalBits < 64)
+    struct ranged final {
+        static constexpr std::size_t FracBits = FractionalBits;
+        static constexpr std::intmax_t RawMin = Min;
+        static constexpr std::intmax_t RawMax = Max;
+        static constexpr std::size_t Bits = std::max(detail::range::bits_for(Min), detail::range::bits_for(Max));
+
+        using storage_type = detail::int_of_bits_t<Bits>;
+
+        storage_type raw;
+
+        // Unchecked, the caller promises raw is in range
+        static constexpr ranged from_raw(storage_type raw) {
+            ranged r;
+            r.raw = raw;
+            return r;
+        }
+
+        // Any value of T, clamped to the range
+        template<is_fixed T>
+        static constexpr ranged clamp(const T& x) {
+            using Wide = __int128;
+            constexpr std::size_t SourceFracBits = T::FracBits;
+
+            Wide value = x.raw;
+            if constexpr (SourceFracBits > FracBits) {
+                value >>= SourceFracBits - FracBits;
+            } else {
+                value <<= FracBits - SourceFracBits;
+            }
+
+            return from_raw(static_cast<storage_type>(std::clamp<Wide>(value, Min, Max)));
+        }
+
+        // Conversion to a plain fixed format, which must be able to
+        // hold the whole range
+        template<is_fixed T>
+        constexpr T to() const {
+            using Storage = typename T::storage_type;
+            constexpr std::size_t TargetFracBits = T::FracBits;
+
+            if constexpr (TargetFracBits >= FracBits) {
+                constexpr std::size_t Shift = TargetFracBits - FracBits;
+
+                static_assert(detail::range::shl(Min, Shift) >= std::numeric_limits<Storage>::min()
+                              && detail::range::shl(Max, Shift) <= std::numeric_limits<Storage>::max(),
+                              "Target format cannot hold the range of this value");
+
+                return T::from_raw(static_cast<Storage>(static_cast<std::intmax_t>(raw) << Shift));
+            } else {
+                constexpr std::size_t Shift = FracBits - TargetFracBits;
+
+                static_assert((Min >> Shift) >= std::numeric_limits<Storage>::min()
+                              && (Max >> Shift) <= std::numeric_limits<Storage>::max(),
+                              "Target format cannot hold the range of this value");
+
+                return T::from_raw(static_cast<Storage>(raw >> Shift));
+            }
+        }
+
+        constexpr explicit operator double() const {
+            return static_cast<double>(raw) / static_cast<double>(std::uintmax_t { 1 } << FracBits);
+        }
+    };
+
+    template<typename T>
+    concept is_ranged = requires {
+        T::FracBits;
+        T::RawMin;
+        T::RawMax;
+    } && std::same_as<T, ranged<T::FracBits, T::RawMin, T::RawMax>>;
+
+    // Full range of a plain fixed value
+    template<is_fixed T>
+    using ranged_of = ranged<static_cast<std::size_t>(T::FracBits),
+                             std::numeric_limits<typename T::storage_type>::min(),
+                             std::numeric_limits<typename T::storage_type>::max()>;
+
+    template<is_fixed T>
+    static constexpr ranged_of<T> as_ranged(const T& x) {
+        return ranged_of<T>::from_raw(x.raw);
+    }
+
+    // A compile time constant has a single point range,
+    // e.g. constant<fixed_q4_12(0.5f)>
+    template<is_fixed auto Value>
+    static constexpr auto constant =
+        ranged<static_cast<std::size_t>(decltype(Value)::FracBits), Value.raw, Value.raw>::from_raw(Value.raw);
+
+    namespace detail::range {
+        template<is_ranged A, is_ranged B>
+        struct sum {
+            static constexpr std::size_t F = std::max(A::FracBits, B::FracBits);
+            static constexpr std::intmax_t AMin = shl(A::RawMin, F - A::FracBits);
+            static constexpr std::intmax_t AMax = shl(A::RawMax, F - A::FracBits);
+            static constexpr std::intmax_t BMin = shl(B::RawMin, F - B::FracBits);
+            static constexpr std::intmax_t BMax = shl(B::RawMax, F - B::FracBits);
+
+            using add = ranged<F, checked(static_cast<__int128>(AMin) + BMin), checked(static_cast<__int128>(AMax) + BMax)>;
+            using sub = ranged<F, checked(static_cast<__int128>(AMin) - BMax), checked(static_cast<__int128>(AMax) - BMin)>;
+        };
+
+        template<is_ranged A, is_ranged B>
+        struct product {
+            static constexpr __int128 P[4] = {
+                static_cast<__int128>(A::RawMin) * B::RawMin,
+                static_cast<__int128>(A::RawMin) * B::RawMax,
+                static_cast<__int128>(A::RawMax) * B::RawMin,
+                static_cast<__int128>(A::RawMax) * B::RawMax,
+            };
+
+            using type = ranged<A::FracBits + B::FracBits,
+                                checked(std::min({ P[0], P[1], P[2], P[3] })),
+                                checked(std::max({ P[0], P[1], P[2], P[3] }))>;
+        };
+    }
+
+    template<is_ranged A, is_ranged B>
+    static constexpr auto operator+(const A& a, const B& b) {
+        using R = typename detail::range::sum<A, B>::add;
+        using S = typename R::storage_type;
+
+        return R::from_raw(static_cast<S>(static_cast<S>(a.raw) * (S { 1 } << (R::FracBits - A::FracBits))
+                                          + static_cast<S>(b.raw) * (S { 1 } << (R::FracBits - B::FracBits))));
+    }
+
+    template<is_ranged A, is_ranged B>
+    static constexpr auto operator-(const A& a, const B& b) {
+        using R = typename detail::range::sum<A, B>::sub;
+        using S = typename R::storage_type;
+
+        return R::from_raw(static_cast<S>(static_cast<S>(a.raw) * (S { 1 } << (R::FracBits - A::FracBits))
+                                          - static_cast<S>(b.raw) * (S { 1 } << (R::FracBits - B::FracBits))));
+    }
+
+    template<is_ranged A, is_ranged B>
+    static constexpr auto operator*(const A& a, const B& b) {
+        using R = typename detail::range::product<A, B>::type;
+        using S = typename R::storage_type;
+
+        return R::from_raw(static_cast<S>(static_cast<S>(a.raw) * static_cast<S>(b.raw)));
+    }
+
+    template<is_ranged A>
+    static constexpr auto operator-(const A& a) {
+        using R = ranged<A::FracBits, detail::range::checked(-static_cast<__int128>(A::RawMax)),
+                         detail::range::checked(-static_cast<__int128>(A::RawMin))>;
+        using S = typename R::storage_type;
+
+        return R::from_raw(static_cast<S>(-static_cast<S>(a.raw)));
+    }
+
+    // Drop fractional bits (rounding toward negative infinity) to keep
+    // the width of long expressions in check
+    template<const std::size_t NewFracBits, is_ranged A>
+    requires (NewFracBits <= A::FracBits)
+    static constexpr auto rescale(const A& a) {
+        constexpr std::size_t Shift = A::FracBits - NewFracBits;
+
+        using R = ranged<NewFracBits, (A::RawMin >> Shift), (A::RawMax >> Shift)>;
+        using S = typename R::storage_type;
+
+        return R::from_raw(static_cast<S>(a.raw >> Shift));
+    }
+
+    template<is_ranged A, is_ranged B>
+    static constexpr bool operator==(const A& a, const B& b) {
+        return (a - b).raw == 0;
+    }
+}
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <aligned.hpp>
+#include <bulk.hpp>
+#include <expr.hpp>
+#include <fixp.hpp>
+#include <linalg.hpp>
+
+namespace fixp {
+    template<typename V>
+    class soa;
+
+    // Structure of arrays storage for vectors of fixed values: each
+    // component lives in its own cache line aligned array, padded with
+    // zeros to a whole number of cache lines. Element access goes
+    // through a proxy that looks like a linalg::vec, while the bulk
+    // operations below run one kernel per component over the padded
+    // length, with every lane in use and no tail loop.
+    //
+    //   fixp::soa<fixp::linalg::vec3<fixed_q16_16>> position(n), velocity(n);
+    //   fixp::fma(velocity, dt, position, position);
+    template<is_fixed T, const std::size_t N>
+    class soa<linalg::vec<T, N>> {
+        public:
+            using value_type = linalg::vec<T, N>;
+            using component_type = T;
+            static constexpr std::size_t Dimensions = N;
+
+            // Element i, read as and assigned from a value_type
+            class reference {
+                private:
+                    soa* owner;
+                    std::size_t index;
+
+                public:
+                    constexpr reference(soa* owner, std::size_t index) : owner(owner), index(index) {}
+                    constexpr reference(const reference&) = default;
+
+                    constexpr operator value_type() const { return owner->load(index); }
+
+                    constexpr const reference& operator=(const value_type& v) const {
+                        owner->store(index, v);
+                        return *this;
+                    }
+
+                    constexpr const reference& operator=(const reference& other) const {
+                        return *this = static_cast<value_type>(other);
+                    }
+
+                    constexpr const reference& operator+=(const value_type& v) const {
+                        return *this = static_cast<value_type>(*this) + v;
+                    }
+
+                    constexpr const reference& operator-=(const value_type& v) const {
+                        return *this = static_cast<value_type>(*this) - v;
+                    }
+
+                    // Component c of the element
+                    constexpr T& operator[](std::size_t c) const { return owner->components[c][index]; }
+            };
+
+            template<bool Const>
+            class basic_iterator {
+                private:
+                    using owner_type = std::conditional_t<Const, const soa, soa>;
+
+                    owner_type* owner = nullptr;
+                    std::ptrdiff_t index = 0;
+
+                public:
+                    using iterator_category = std::random_access_iterator_tag;
+                    using value_type = soa::value_type;
+                    using difference_type = std::ptrdiff_t;
+                    using reference = std::conditional_t<Const, soa::value_type, soa::reference>;
+
+                    constexpr basic_iterator() = default;
+                    constexpr basic_iterator(owner_type* owner, std::ptrdiff_t index) : owner(owner), index(index) {}
+
+                    constexpr reference operator*() const { return (*owner)[static_cast<std::size_t>(index)]; }
+                    constexpr reference operator[](difference_type n) const { return *(*this + n); }
+
+                    constexpr basic_iterator& operator++() { index++; return *this; }
+                    constexpr basic_iterator& operator--() { index--; return *this; }
+                    constexpr basic_iterator operator++(int) { auto it = *this; index++; return it; }
+                    constexpr basic_iterator operator--(int) { auto it = *this; index--; return it; }
+                    constexpr basic_iterator& operator+=(difference_type n) { index += n; return *this; }
+                    constexpr basic_iterator& operator-=(difference_type n) { index -= n; return *this; }
+
+                    friend constexpr basic_iterator operator+(basic_iterator it, difference_type n) { return it += n; }
+                    friend constexpr basic_iterator operator+(difference_type n, basic_iterator it) { return it += n; }
+                    friend constexpr basic_iterator operator-(basic_iterator it, difference_type n) { return it -= n; }
+                    friend constexpr difference_type operator-(const basic_iterator& a, const basic_iterator& b) { return a.index - b.index; }
+
+                    friend constexpr bool operator==(const basic_iterator& a, const basic_iterator& b) { return a.index == b.index; }
+                    friend constexpr auto operator<=>(const basic_iterator& a, const basic_iterator& b) { return a.index <=> b.index; }
+            };
+
+            using iterator = basic_iterator<false>;
+            using const_iterator = basic_iterator<true>;
+
+        private:
+            std::array<std::vector<T, aligned_allocator<T>>, N> components;
+            std::size_t count = 0;
+
+            constexpr value_type load(std::size_t i) const {
+                return [&]<std::size_t... C>(std::index_sequence<C...>) {
+                    return value_type(components[C][i]...);
+                }(std::make_index_sequence<N> {});
+            }
+
+            constexpr void store(std::size_t i, const value_type& v) {
+                for (std::size_t c = 0; c < N; c++) {
+                    components[c][i] = v[c];
+                }
+            }
+
+        public:
+            soa() = default;
+
+            explicit soa(std::size_t n) { resize(n); }
+
+            soa(std::initializer_list<value_type> values) {
+                reserve(values.size());
+                for (const value_type& v : values) {
+                    push_back(v);
+                }
+            }
+
+            std::size_t size() const { return count; }
+            bool empty() const { return count == 0; }
+
+            // Length of each component array including the padding,
+            // which the bulk operations run over
+            std::size_t padded_size() const { return components[0].size(); }
+
+            void reserve(std::size_t n) {
+                for (auto& component : components) {
+                    component.reserve(fixp::padded_size<T>(n));
+                }
+            }
+
+            // New elements are zero
+            void resize(std::size_t n) {
+                for (auto& component : components) {
+                    component.resize(fixp::padded_size<T>(n));
+
+                    // Everything past the old end is either a new
+                    // element or padding
+                    std::fill(component.begin() + static_cast<std::ptrdiff_t>(std::min(n, count)), component.end(), T::from_raw(0));
+                }
+
+                count = n;
+            }
+
+            void push_back(const value_type& v) {
+                if (count == padded_size()) {
+                    for (auto& component : components) {
+                        component.resize(fixp::padded_size<T>(count + 1), T::from_raw(0));
+                    }
+                }
+
+                store(count++, v);
+            }
+
+            void clear() { resize(0); }
+
+            reference operator[](std::size_t i) { return { this, i }; }
+            value_type operator[](std::size_t i) const { return load(i); }
+
+            // The contiguous, aligned array of component c
+            T* component(std::size_t c) { return components[c].data(); }
+            const T* component(std::size_t c) const { return components[c].data(); }
+
+            iterator begin() { return { this, 0 }; }
+            iterator end() { return { this, static_cast<std::ptrdiff_t>(count) }; }
+            const_iterator begin() const { return { this, 0 }; }
+            const_iterator end() const { return { this, static_cast<std::ptrdiff_t>(count) }; }
+    };
+
+    template<typename T>
+    concept is_soa = requires {
+        typename T::value_type;
+        typename T::component_type;
+        T::Dimensions;
+    } && std::same_as<T, soa<linalg::vec<typename T::component_type, T::Dimensions>>>;
+
+    namespace detail::soa {
+        // Calls f(c) for every component c
+        template<std::size_t N, typename F>
+        static inline void for_each_component(F&& f) {
+            [&]<std::size_t... C>(std::index_sequence<C...>) {
+                (f(C), ...);
+            }(std::make_index_sequence<N> {});
+        }
+    }
+
+    // The functions below take a and b to have the same size (checked
+    // with assert); out is resized to match.
+
+    // out = a + b. out may be a or b
+    template<is_soa S>
+    static inline void
+    add(const S& a, const S& b, S& out) {
+        assert(b.size() == a.size());
+        out.resize(a.size());
+        detail::soa::for_each_component<S::Dimensions>([&](std::size_t c) {
+            expr::assign(out.component(c), lazy(a.component(c), a.padded_size()) + lazy(b.component(c), a.padded_size()));
+        });
+    }
+
+    // out = a - b. out may be a or b
+    template<is_soa S>
+    static inline void
+    sub(const S& a, const S& b, S& out) {
+        assert(b.size() == a.size());
+        out.resize(a.size());
+        detail::soa::for_each_component<S::Dimensions>([&](std::size_t c) {
+            expr::assign(out.component(c), lazy(a.component(c), a.padded_size()) - lazy(b.component(c), a.padded_size()));
+        });
+    }
+
+    // out = a * k. out may be a
+    template<is_soa S>
+    static inline void
+    scale(const S& a, const typename S::component_type& k, S& out) {
+        out.resize(a.size());
+        detail::soa::for_each_component<S::Dimensions>([&](std::size_t c) {
+            expr::assign(out.component(c), lazy(a.component(c), a.padded_size()) * k);
+        });
+    }
+
+    // out = a * k + b with a single rounding, e.g. position += velocity
+    // * dt. out may be a or b
+    template<rounding Rounding = rounding::nearest, is_soa S>
+    static inline void
+    fma(const S& a, const typename S::component_type& k, const S& b, S& out) {
+        assert(b.size() == a.size());
+        out.resize(a.size());
+        detail::soa::for_each_component<S::Dimensions>([&](std::size_t c) {
+            fma<Rounding>(a.component(c), k, b.component(c), out.component(c), a.padded_size());
+        });
+    }
+
+    // out[i] = dot(a[i], b[i]) for a.size() elements
+    template<is_soa S>
+    static inline void
+    dot(const S& a, const S& b, typename S::component_type* out) {
+        assert(b.size() == a.size());
+        const std::size_t n = a.size();
+
+        expr::assign(out, [&]<std::size_t... C>(std::index_sequence<C...>) {
+            return (... + (lazy(a.component(C), n) * lazy(b.component(C), n)));
+        }(std::make_index_sequence<S::Dimensions> {}));
+    }
+}
@@ -1,18 +1,51 @@
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <fixp.hpp>
+#include <span>
 #include <utility>
+#include <vector>
 #include <sciplot/sciplot.hpp>
 
 #include <simd_neon.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <fir.hpp>
+#include <biquad.hpp>
+#include <fft.hpp>
+#include <complex.hpp>
+#include <nco.hpp>
+#include <bulk.hpp>
+#include <ranged.hpp>
+#include <divider.hpp>
+#include <expr.hpp>
+#include <soa.hpp>
+#include <array.hpp>
+#include <view.hpp>
+#include <dataset.hpp>
+#include <bitpacked.hpp>
+#include <codec.hpp>
+#include <pipeline.hpp>
+#include <parallel.hpp>
+#include <pool.hpp>
+
 using fixed_q16_16 = fixp::fixed<16, std::int32_t, std::int64_t>;
 using fixed_q4_12 = fixp::fixed<12, std::int16_t, std::int32_t>;
 using fixed_q8_8 = fixp::fixed<8, std::int16_t, std::int32_t>;
+using fixed_q0_15 = fixp::fixed<15, std::int16_t, std::int32_t>;
+using fixed_q2_14 = fixp::fixed<14, std::int16_t, std::int32_t>;
+using fixed_q32_32 = fixp::fixed<32, std::int64_t, __int128>;
+using fixed_uq0_16 = fixp::fixed<16, std::uint16_t, std::uint32_t>;
+using fixed_uq8_8 = fixp::fixed<8, std::uint16_t, std::uint32_t>;
+using fixed_uq0_8 = fixp::fixed<8, std::uint8_t, std::uint16_t>;
 
 namespace graphs {
     template<fixp::is_fixed T>
@@ -186,6 +219,1741 @@ test_cstr()
     return 0;
 }
 
+int
+test_fir()
+{
+    using fixed = fixed_q0_15;
+    constexpr std::size_t Taps = 12;
+    constexpr std::size_t N = 100;
+
+    std::array<fixed, Taps> coeffs;
+    for (std::size_t i = 0; i < Taps; i++) {
+        coeffs[i] = fixed::from_raw(static_cast<std::int16_t>(1000 * (i + 1)));
+    }
+
+    fixed in[N];
+    for (std::size_t i = 0; i < N; i++) {
+        in[i] = fixed::from_raw(static_cast<std::int16_t>(rand() % 20000 - 10000));
+    }
+
+    // Reference: direct convolution
+    fixed expected[N];
+    for (std::size_t n = 0; n < N; n++) {
+        std::int32_t acc = 0;
+        for (std::size_t k = 0; k < Taps && k <= n; k++) {
+            acc += static_cast<std::int32_t>(coeffs[k].raw) * in[n - k].raw;
+        }
+        expected[n] = fixed::from_raw(static_cast<std::int16_t>((acc + (1 << 14)) >> 15));
+    }
+
+    // Split into uneven blocks to exercise the streaming state
+    fixp::dsp::fir<fixed, Taps> filter(coeffs);
+    fixed out[N];
+    filter.process(in, out, 7);
+    filter.process(in + 7, out + 7, N - 7);
+
+    for (std::size_t i = 0; i < N; i++) {
+        assert(out[i] == expected[i]);
+    }
+
+    fixp::dsp::fir_decimator<fixed, Taps, 3> decimator(coeffs);
+    fixed decimated[N];
+    std::size_t n_decimated = decimator.process(in, decimated, 50);
+    n_decimated += decimator.process(in + 50, decimated + n_decimated, N - 50);
+
+    assert(n_decimated == N / 3);
+    for (std::size_t i = 0; i < n_decimated; i++) {
+        assert(decimated[i] == expected[i * 3 + 2]);
+    }
+
+    // Interpolation must match filtering the zero-stuffed signal
+    constexpr std::size_t L = 4;
+    fixed stuffed[N * L];
+    for (std::size_t i = 0; i < N * L; i++) {
+        stuffed[i] = i % L == 0 ? in[i / L] : fixed::from_raw(0);
+    }
+
+    fixp::dsp::fir<fixed, Taps> reference(coeffs);
+    fixed stuffed_out[N * L];
+    reference.process(stuffed, stuffed_out, N * L);
+
+    fixp::dsp::fir_interpolator<fixed, Taps, L> interpolator(coeffs);
+    fixed interpolated[N * L];
+    interpolator.process(in, interpolated, N);
+
+    for (std::size_t i = 0; i < N * L; i++) {
+        assert(interpolated[i] == stuffed_out[i]);
+    }
+
+    // Gain above 1 on full scale input: the 64 bit accumulator has the
+    // headroom, and the output saturates instead of wrapping
+    static_assert(std::is_same_v<fixp::dsp::fir<fixed, 4>::accumulator_type, std::int64_t>);
+
+    fixp::dsp::fir<fixed, 4> loud({ fixed(0.5f), fixed(0.5f), fixed(0.5f), fixed(0.5f) });
+    const fixed full_scale[4] = { fixed::from_raw(32767), fixed::from_raw(32767), fixed::from_raw(32767), fixed::from_raw(32767) };
+    fixed loud_out[4];
+    loud.process(full_scale, loud_out, 4);
+
+    assert(loud_out[0].raw == 16384);
+    assert(loud_out[1].raw == 32767);
+    assert(loud_out[3].raw == 32767);
+
+    // Partial sums past 2^31 that cancel out again
+    fixp::dsp::fir<fixed, 4> cancel({ fixed(-0.99f), fixed(-0.99f), fixed(0.99f), fixed(0.99f) });
+    cancel.process(full_scale, loud_out, 4);
+    assert(loud_out[3].raw == 0);
+
+    std::cout << "fir: OK" << std::endl;
+
+    return 0;
+}
+
+template<fixp::dsp::biquad_form Form>
+static void
+check_biquad()
+{
+    using fixed = fixed_q0_15;
+    using coeff = fixed_q2_14;
+    using cascade = fixp::dsp::biquad_cascade<fixed, 2, 4, Form, coeff>;
+
+    constexpr std::size_t Channels = 4;
+    constexpr std::size_t Frames = 500;
+
+    // RBJ lowpass, cutoff at fs / 10
+    const double w0 = 2.0 * std::numbers::pi * 0.1;
+    const double alpha = std::sin(w0) / (2.0 * std::numbers::sqrt2);
+    const double a0 = 1.0 + alpha;
+    const double b[3] = { (1.0 - std::cos(w0)) / 2.0 / a0, (1.0 - std::cos(w0)) / a0, (1.0 - std::cos(w0)) / 2.0 / a0 };
+    const double a[2] = { -2.0 * std::cos(w0) / a0, (1.0 - alpha) / a0 };
+
+    const typename cascade::coefficients section = {
+        static_cast<float>(b[0]), static_cast<float>(b[1]), static_cast<float>(b[2]),
+        static_cast<float>(a[0]), static_cast<float>(a[1]),
+    };
+
+    fixed in[Frames * Channels];
+    for (std::size_t n = 0; n < Frames; n++) {
+        for (std::size_t ch = 0; ch < Channels; ch++) {
+            in[n * Channels + ch] = static_cast<float>(0.4 * std::sin(0.05 * n * (ch + 1)) + 0.02 * std::sin(2.5 * n));
+        }
+    }
+
+    cascade filter({ section, section });
+    fixed out[Frames * Channels];
+    filter.process(in, out, Frames / 2);
+    filter.process(in + Frames / 2 * Channels, out + Frames / 2 * Channels, Frames - Frames / 2);
+
+    // Reference with the same quantized coefficients in double
+    const double qb[3] = { static_cast<double>(section.b0), static_cast<double>(section.b1), static_cast<double>(section.b2) };
+    const double qa[2] = { static_cast<double>(section.a1), static_cast<double>(section.a2) };
+
+    double max_error = 0.0;
+    for (std::size_t ch = 0; ch < Channels; ch++) {
+        double state[2][4] = { };
+
+        for (std::size_t n = 0; n < Frames; n++) {
+            double x = static_cast<double>(in[n * Channels + ch]);
+
+            for (auto& st : state) {
+                const double y = qb[0] * x + qb[1] * st[0] + qb[2] * st[1] - qa[0] * st[2] - qa[1] * st[3];
+                st[1] = st[0];
+                st[0] = x;
+                st[3] = st[2];
+                st[2] = y;
+                x = y;
+            }
+
+            max_error = std::max(max_error, std::abs(x - static_cast<double>(out[n * Channels + ch])));
+        }
+    }
+
+    std::cout << "biquad: max error " << max_error << std::endl;
+    assert(max_error < 8.0 / 32768.0);
+
+    // Every channel must be filtered independently
+    fixed mono_in[Frames];
+    fixed mono_out[Frames];
+    for (std::size_t n = 0; n < Frames; n++) {
+        mono_in[n] = in[n * Channels + 2];
+    }
+
+    fixp::dsp::biquad_cascade<fixed, 2, 1, Form, coeff> mono({ section, section });
+    mono.process(mono_in, mono_out, Frames);
+
+    for (std::size_t n = 0; n < Frames; n++) {
+        assert(mono_out[n] == out[n * Channels + 2]);
+    }
+
+    // A full-scale step into a highpass overshoots full scale, which
+    // has to saturate instead of wrapping inside the feedback loop
+    const double hb[3] = { (1.0 + std::cos(w0)) / 2.0 / a0, -(1.0 + std::cos(w0)) / a0, (1.0 + std::cos(w0)) / 2.0 / a0 };
+    const typename cascade::coefficients highpass = {
+        static_cast<float>(hb[0]), static_cast<float>(hb[1]), static_cast<float>(hb[2]),
+        static_cast<float>(a[0]), static_cast<float>(a[1]),
+    };
+
+    for (std::size_t n = 0; n < Frames; n++) {
+        mono_in[n] = fixed::from_raw(n < Frames / 2 ? std::numeric_limits<std::int16_t>::min() : std::numeric_limits<std::int16_t>::max());
+    }
+
+    fixp::dsp::biquad_cascade<fixed, 1, 1, Form, coeff> step({ highpass });
+    step.process(mono_in, mono_out, Frames);
+
+    const double hqb[3] = { static_cast<double>(highpass.b0), static_cast<double>(highpass.b1), static_cast<double>(highpass.b2) };
+    const double hqa[2] = { static_cast<double>(highpass.a1), static_cast<double>(highpass.a2) };
+    double st[4] = { };
+
+    max_error = 0.0;
+    for (std::size_t n = 0; n < Frames; n++) {
+        const double x = static_cast<double>(mono_in[n]);
+        const double y = std::clamp(hqb[0] * x + hqb[1] * st[0] + hqb[2] * st[1] - hqa[0] * st[2] - hqa[1] * st[3], -1.0, 32767.0 / 32768.0);
+
+        st[1] = st[0];
+        st[0] = x;
+        st[3] = st[2];
+        st[2] = y;
+
+        max_error = std::max(max_error, std::abs(y - static_cast<double>(mono_out[n])));
+    }
+
+    assert(mono_out[Frames / 2].raw == std::numeric_limits<std::int16_t>::max());
+    assert(max_error < 8.0 / 32768.0);
+}
+
+int
+test_biquad()
+{
+    check_biquad<fixp::dsp::biquad_form::df1_error_feedback>();
+    check_biquad<fixp::dsp::biquad_form::transposed_df2>();
+
+    std::cout << "biquad: OK" << std::endl;
+
+    return 0;
+}
+
+template<fixp::is_fixed T, const std::size_t N, const fixp::dsp::fft_scaling Scaling>
+static double
+check_fft(double amplitude)
+{
+    using fft = fixp::dsp::fft<T, N, Scaling>;
+    using rfft = fixp::dsp::rfft<T, N, Scaling>;
+
+    std::vector<T> data(2 * N);
+    std::vector<double> input(2 * N);
+    for (std::size_t i = 0; i < 2 * N; i++) {
+        data[i] = static_cast<float>(amplitude * (2.0 * rand() / RAND_MAX - 1.0));
+        input[i] = static_cast<double>(data[i]);
+    }
+
+    std::vector<double> expected(2 * N);
+    double peak = 0.0;
+    for (std::size_t k = 0; k < N; k++) {
+        double re = 0.0;
+        double im = 0.0;
+
+        for (std::size_t n = 0; n < N; n++) {
+            const double angle = -2.0 * std::numbers::pi * static_cast<double>(k * n % N) / N;
+            re += input[2 * n] * std::cos(angle) - input[2 * n + 1] * std::sin(angle);
+            im += input[2 * n] * std::sin(angle) + input[2 * n + 1] * std::cos(angle);
+        }
+
+        expected[2 * k] = re;
+        expected[2 * k + 1] = im;
+        peak = std::max({ peak, std::abs(re), std::abs(im) });
+    }
+
+    const int exponent = fft::forward(data.data());
+
+    double max_error = 0.0;
+    for (std::size_t i = 0; i < 2 * N; i++) {
+        max_error = std::max(max_error, std::abs(std::ldexp(static_cast<double>(data[i]), exponent) - expected[i]));
+    }
+
+    // Round trip through the inverse. Scaling per stage on the way
+    // back as well leaves nothing but quantization noise, so skip it.
+    if constexpr (Scaling != fixp::dsp::fft_scaling::per_stage) {
+        const int inverse_exponent = fft::inverse(data.data()) + exponent - static_cast<int>(fft::Log2Size);
+        for (std::size_t i = 0; i < 2 * N; i++) {
+            max_error = std::max(max_error, std::abs(std::ldexp(static_cast<double>(data[i]), inverse_exponent) - input[i]) * N);
+        }
+    }
+
+    // Real FFT of the real parts against the same reference
+    std::vector<T> real(N + 2);
+    for (std::size_t n = 0; n < N; n++) {
+        real[n] = static_cast<float>(input[2 * n]);
+    }
+
+    const int real_exponent = rfft::forward(real.data(), real.data());
+
+    for (std::size_t k = 0; k < rfft::Bins; k++) {
+        double re = 0.0;
+        double im = 0.0;
+
+        for (std::size_t n = 0; n < N; n++) {
+            const double angle = -2.0 * std::numbers::pi * static_cast<double>(k * n % N) / N;
+            re += input[2 * n] * std::cos(angle);
+            im += input[2 * n] * std::sin(angle);
+        }
+
+        max_error = std::max(max_error, std::abs(std::ldexp(static_cast<double>(real[2 * k]), real_exponent) - re));
+        max_error = std::max(max_error, std::abs(std::ldexp(static_cast<double>(real[2 * k + 1]), real_exponent) - im));
+    }
+
+    return max_error / peak;
+}
+
+int
+test_fft()
+{
+    using scaling = fixp::dsp::fft_scaling;
+
+    const double errors[] = {
+        check_fft<fixed_q0_15, 256, scaling::block_floating_point>(0.9),
+        check_fft<fixed_q0_15, 256, scaling::per_stage>(0.5),
+        check_fft<fixed_q16_16, 64, scaling::none>(1.0),
+        check_fft<fixed_q16_16, 1024, scaling::block_floating_point>(1000.0),
+        check_fft<fixed_q32_32, 256, scaling::block_floating_point>(1000.0),
+    };
+
+    for (double e : errors) {
+        std::cout << "fft: relative error " << e << std::endl;
+    }
+
+    assert(errors[0] < 1e-2);
+    assert(errors[1] < 5e-3);
+    assert(errors[2] < 1e-3);
+    assert(errors[3] < 1e-5);
+    assert(errors[4] < 1e-5);
+
+    // Full scale alternating input puts everything in the N/2 bin,
+    // the worst case for the real FFT split step
+    {
+        using rfft = fixp::dsp::rfft<fixed_q32_32, 16>;
+
+        std::vector<fixed_q32_32> x(rfft::Size + 2);
+        for (std::size_t n = 0; n < rfft::Size; n++) {
+            x[n] = fixed_q32_32::from_raw(n % 2 == 0 ? std::numeric_limits<std::int64_t>::max() : std::numeric_limits<std::int64_t>::min());
+        }
+
+        const int exponent = rfft::forward(x.data(), x.data());
+        const double expected = std::ldexp(static_cast<double>(rfft::Size), 31);
+        const double nyquist = std::ldexp(static_cast<double>(x[rfft::Size]), exponent);
+
+        assert(std::abs(nyquist - expected) < 1e-6 * std::abs(expected));
+        for (std::size_t k = 0; k < rfft::Bins - 1; k++) {
+            assert(std::abs(std::ldexp(static_cast<double>(x[2 * k]), exponent)) < 1e-6 * std::abs(expected));
+        }
+    }
+
+    std::cout << "fft: OK" << std::endl;
+
+    return 0;
+}
+
+template<fixp::is_fixed T>
+static void
+check_complex()
+{
+    using complex = fixp::complex<T>;
+    using Storage = typename T::storage_type;
+    using Intermediate = typename T::intermediate_type;
+
+    // Odd length to exercise the scalar tail
+    constexpr std::size_t N = 203;
+
+    std::vector<complex> a(N);
+    std::vector<complex> b(N);
+    for (std::size_t i = 0; i < N; i++) {
+        a[i] = { static_cast<float>(2.0 * rand() / RAND_MAX - 1.0), static_cast<float>(2.0 * rand() / RAND_MAX - 1.0) };
+        b[i] = { static_cast<float>(2.0 * rand() / RAND_MAX - 1.0), static_cast<float>(2.0 * rand() / RAND_MAX - 1.0) };
+    }
+
+    std::vector<complex> product(N);
+    std::vector<complex> product_conj(N);
+    std::vector<T> norms(N);
+    fixp::mul(a.data(), b.data(), product.data(), N);
+    fixp::mul_conj(a.data(), b.data(), product_conj.data(), N);
+    fixp::norm(a.data(), norms.data(), N);
+
+    fixp::accumulator_t<T> re = 0;
+    fixp::accumulator_t<T> im = 0;
+    for (std::size_t i = 0; i < N; i++) {
+        const Intermediate ar = a[i].re.raw;
+        const Intermediate ai = a[i].im.raw;
+        const Intermediate br = b[i].re.raw;
+        const Intermediate bi = b[i].im.raw;
+
+        assert(product[i].re.raw == static_cast<Storage>((ar * br - ai * bi) >> T::FracBits));
+        assert(product[i].im.raw == static_cast<Storage>((ar * bi + ai * br) >> T::FracBits));
+        assert(product_conj[i] == a[i] * fixp::conj(b[i]));
+        assert(norms[i] == fixp::norm(a[i]));
+
+        re += ar * br + ai * bi;
+        im += ai * br - ar * bi;
+    }
+
+    const complex correlation = fixp::dot_conj(a.data(), b.data(), N);
+    assert(correlation.re.raw == static_cast<Storage>(re >> T::FracBits));
+    assert(correlation.im.raw == static_cast<Storage>(im >> T::FracBits));
+
+    // Purely real values behave like plain fixed multiplication
+    const complex x = { T(1.5f), T(0.0f) };
+    const complex y = { T(-0.75f), T(0.0f) };
+    assert((x * y).re == T(1.5f) * T(-0.75f));
+}
+
+int
+test_complex()
+{
+    check_complex<fixed_q4_12>();
+    check_complex<fixed_q16_16>();
+
+    // Full scale Q15 correlation: a single term already needs 32 bits,
+    // the alternating signs cancel out in the end
+    std::vector<fixp::complex<fixed_q0_15>> full(1000), alternating(1000);
+    for (std::size_t i = 0; i < full.size(); i++) {
+        const auto max = fixed_q0_15::from_raw(32767);
+        const auto min = fixed_q0_15::from_raw(-32767);
+
+        full[i] = { max, max };
+        alternating[i] = i % 2 == 0 ? fixp::complex<fixed_q0_15> { max, max } : fixp::complex<fixed_q0_15> { min, min };
+    }
+
+    const fixp::complex<fixed_q0_15> cancelled = fixp::dot_conj(full.data(), alternating.data(), full.size());
+    assert(cancelled.re.raw == 0 && cancelled.im.raw == 0);
+
+    std::cout << "complex: OK" << std::endl;
+
+    return 0;
+}
+
+int
+test_nco()
+{
+    using fixed = fixed_q0_15;
+    using lookup = fixp::dsp::nco_lookup;
+    constexpr std::size_t Channels = 3;
+    constexpr std::size_t Frames = 1000;
+
+    const double frequencies[Channels] = { 0.01, 0.123, -0.2 };
+
+    fixp::dsp::nco<fixed, Channels, 10, lookup::interpolated> oscillator;
+    fixp::dsp::nco<fixed, Channels, 10, lookup::nearest, true> dithered;
+    for (std::size_t ch = 0; ch < Channels; ch++) {
+        oscillator.set_frequency(ch, frequencies[ch]);
+        dithered.set_frequency(ch, frequencies[ch]);
+    }
+
+    // Generate in two blocks to check the phase carries over
+    std::vector<fixp::complex<fixed>> out(Frames * Channels);
+    oscillator.generate(out.data(), Frames / 3);
+    oscillator.generate(out.data() + Frames / 3 * Channels, Frames - Frames / 3);
+
+    std::vector<fixed> out_dithered(Frames * Channels);
+    dithered.generate(out_dithered.data(), Frames);
+
+    double max_error = 0.0;
+    double max_error_dithered = 0.0;
+    for (std::size_t n = 0; n < Frames; n++) {
+        for (std::size_t ch = 0; ch < Channels; ch++) {
+            const double angle = 2.0 * std::numbers::pi * frequencies[ch] * n;
+            const fixp::complex<fixed>& z = out[n * Channels + ch];
+
+            max_error = std::max(max_error, std::abs(static_cast<double>(z.re) - std::cos(angle)));
+            max_error = std::max(max_error, std::abs(static_cast<double>(z.im) - std::sin(angle)));
+            max_error_dithered = std::max(max_error_dithered, std::abs(static_cast<double>(out_dithered[n * Channels + ch]) - std::sin(angle)));
+        }
+    }
+
+    std::cout << "nco: max error " << max_error << ", dithered nearest " << max_error_dithered << std::endl;
+    assert(max_error < 1e-4);
+    assert(max_error_dithered < 2e-2);
+
+    // Undithered nearest rounds the phase to the closest entry, so a
+    // phase just short of an entry gives that entry, not the one
+    // before it. Interpolation is not needed for this, so a format
+    // with no wider intermediate type works too.
+    using narrow = fixp::fixed<15, std::int16_t, std::int16_t>;
+    fixp::dsp::nco<narrow, 1, 4, lookup::nearest> coarse;
+
+    const auto first = [&](std::uint32_t p) {
+        narrow y;
+        coarse.set_phase(0, p);
+        coarse.generate(&y, 1);
+        return static_cast<double>(y);
+    };
+
+    // 16 entries, so 1 << 28 is a sixteenth of a turn
+    assert(std::abs(first((std::uint32_t { 4 } << 28) - 1) - 1.0) < 1e-4);
+    assert(std::abs(first((std::uint32_t { 1 } << 27) + 1) - std::sin(std::numbers::pi / 8)) < 1e-4);
+    assert(std::abs(first(0xffffffffu)) < 1e-4);
+
+    std::cout << "nco: OK" << std::endl;
+
+    return 0;
+}
+
+template<fixp::is_fixed T, std::floating_point F>
+static void
+check_conversion()
+{
+    using Storage = typename T::storage_type;
+    using limits = std::numeric_limits<Storage>;
+
+    const F lsb = static_cast<F>(1) / static_cast<F>(T::Scale);
+    const F max = static_cast<F>(limits::max()) * lsb;
+    const F min = static_cast<F>(limits::min()) * lsb;
+
+    const F in[] = {
+        0, 0.5f, -0.5f, 2.5f * lsb, 3.5f * lsb, -2.5f * lsb, 0.75f * lsb, -0.75f * lsb,
+        max * 2, min * 2, std::numeric_limits<F>::infinity(), -std::numeric_limits<F>::infinity(),
+        std::numeric_limits<F>::quiet_NaN(), 0.3f, -0.3f, 1000000000.0f,
+    };
+    constexpr std::size_t N = sizeof(in) / sizeof(in[0]);
+
+    const Storage nearest[N] = {
+        0, static_cast<Storage>(T::Scale / 2), static_cast<Storage>(-T::Scale / 2), 2, 4, -2, 1, -1,
+        limits::max(), limits::min(), limits::max(), limits::min(),
+        0, static_cast<Storage>(std::nearbyint(F(0.3f) * T::Scale)), static_cast<Storage>(std::nearbyint(F(-0.3f) * T::Scale)), limits::max(),
+    };
+    const Storage truncated[N] = {
+        0, static_cast<Storage>(T::Scale / 2), static_cast<Storage>(-T::Scale / 2), 2, 3, -2, 0, 0,
+        limits::max(), limits::min(), limits::max(), limits::min(),
+        0, static_cast<Storage>(F(0.3f) * T::Scale), static_cast<Storage>(F(-0.3f) * T::Scale), limits::max(),
+    };
+
+    T out_nearest[N];
+    T out_truncated[N];
+    fixp::from_float(in, out_nearest, N);
+    fixp::from_float<fixp::rounding::truncate>(in, out_truncated, N);
+
+    for (std::size_t i = 0; i < N; i++) {
+        assert(out_nearest[i].raw == nearest[i]);
+        assert(out_truncated[i].raw == truncated[i]);
+    }
+
+    F back[N];
+    fixp::to_float(out_nearest, back, N);
+    for (std::size_t i = 0; i < N; i++) {
+        assert(back[i] == static_cast<F>(out_nearest[i].raw) * lsb);
+    }
+}
+
+int
+test_conversion()
+{
+    check_conversion<fixed_q0_15, float>();
+    check_conversion<fixed_q4_12, float>();
+    check_conversion<fixed_q16_16, float>();
+    check_conversion<fixed_q16_16, double>();
+
+    std::cout << "conversion: OK" << std::endl;
+
+    return 0;
+}
+
+int
+test_literals()
+{
+    using namespace fixp::literals;
+
+    // All of these are evaluated at compile time
+    static_assert((1.5_q16).raw == 0x18000);
+    static_assert((0.70710678_q15).raw == 23170);
+    static_assert((1e-3_q16).raw == 66);
+    static_assert((1'000.25_q16).raw == 1000 * 65536 + 16384);
+    static_assert((-2.75_q8).raw == -704);
+    static_assert((3_q12).raw == 3 << 12);
+
+    // Exactly half an LSB rounds away from zero, anything less does not
+    static_assert((0.0000152587890625_q15).raw == 1);
+    static_assert((0.0000152587890624_q15).raw == 0);
+
+    static_assert(fixed_q16_16::from_ratio(1, 3).raw == 21845);
+    static_assert(fixed_q16_16::from_ratio(-2, 3).raw == -43691);
+    static_assert(fixed_q32_32::from_ratio(1, 3).raw == 1431655765);
+    static_assert(fixed_q32_32::from_ratio(-7, 2).raw == -(std::int64_t { 7 } << 31));
+    static_assert(fixed_uq0_16::from_ratio(1, 3).raw == 21845);
+
+    constexpr fixed_q16_16 pi = std::numbers::pi_v<double>;
+    static_assert(pi.raw == 205887);
+
+    std::cout << fixp::to_string(1.5_q16) << " " << fixp::to_string(pi) << std::endl;
+    std::cout << "literals: OK" << std::endl;
+
+    return 0;
+}
+
+int
+test_mixed()
+{
+    using coeff = fixed_q4_12;
+    using sample = fixed_q16_16;
+    using product = fixp::product_t<coeff, sample>;
+
+    static_assert(std::is_same_v<product, fixp::fixed<28, std::int64_t, std::int64_t>>);
+    static_assert(std::is_same_v<fixp::sum_t<fixed_q8_8, fixed_q4_12>, fixp::fixed<12, std::int32_t, std::int32_t>>);
+    static_assert(std::is_same_v<fixp::sum_t<fixed_q8_8, fixed_q16_16>, fixp::fixed<16, std::int64_t, std::int64_t>>);
+
+    const coeff c0 = 0.123f;
+    const coeff c1 = -1.75f;
+    const sample x0 = 1234.5678f;
+    const sample x1 = -42.125f;
+
+    // The whole expression stays exact, one shift at the end
+    const sample y = sample(c0 * x0 + c1 * x1);
+    const std::int64_t exact = static_cast<std::int64_t>(c0.raw) * x0.raw + static_cast<std::int64_t>(c1.raw) * x1.raw;
+    assert(y.raw == static_cast<std::int32_t>(exact >> coeff::FracBits));
+
+    // Mixed sums align to the finer format
+    const auto sum = fixed_q8_8(1.5f) + fixed_q4_12(0.25f);
+    assert(static_cast<float>(sum) == 1.75f);
+    assert(static_cast<float>(fixed_q8_8(1.5f) - sample(100.25f)) == -98.75f);
+
+    // Conversions between formats
+    assert(fixed_q8_8(fixed_q4_12(2.5f)) == fixed_q8_8(2.5f));
+    assert(sample(fixed_q4_12(-3.25f)) == sample(-3.25f));
+
+    std::cout << "mixed: " << fixp::to_string(y) << std::endl;
+    std::cout << "mixed: OK" << std::endl;
+
+    return 0;
+}
+
+int
+test_ranged()
+{
+    using fixp::constant;
+
+    // A 12 bit ADC reading in [0, 4095] and a gain in [-2, 2) at Q1.14
+    using adc = fixp::ranged<0, 0, 4095>;
+    using gain = fixp::ranged<14, -2 * 16384, 2 * 16384 - 1>;
+
+    static_assert(std::is_same_v<adc::storage_type, std::int16_t>);
+    static_assert(std::is_same_v<fixp::ranged<0, 0, 127>::storage_type, std::int8_t>);
+    static_assert(std::is_same_v<fixp::ranged<0, -128, 127>::storage_type, std::int8_t>);
+    static_assert(std::is_same_v<fixp::ranged<0, 0, 128>::storage_type, std::int16_t>);
+
+    const adc x = adc::from_raw(4000);
+    const gain g = gain::clamp(fixed_q4_12(1.5f));
+
+    // The product can reach -2 * 4095 and widens to 32 bits, the
+    // difference of two readings stays at 16
+    const auto y = x * g;
+    static_assert(decltype(y)::RawMin == -2 * 16384 * 4095);
+    static_assert(decltype(y)::RawMax == (2 * 16384 - 1) * 4095);
+    static_assert(std::is_same_v<decltype(y)::storage_type, std::int32_t>);
+    assert(static_cast<double>(y) == 6000.0);
+
+    const auto d = x - adc::from_raw(95);
+    static_assert(decltype(d)::RawMin == -4095 && decltype(d)::RawMax == 4095);
+    static_assert(std::is_same_v<decltype(d)::storage_type, std::int16_t>);
+    assert(d.raw == 3905);
+
+    // Constants contribute a single point range
+    const auto offset = y + constant<fixed_q4_12(0.25f)>;
+    static_assert(decltype(offset)::FracBits == 14);
+    static_assert(decltype(offset)::RawMin == decltype(y)::RawMin + 4096);
+    assert(static_cast<double>(offset) == 6000.25);
+
+    const auto n = -g;
+    static_assert(decltype(n)::RawMin == -(2 * 16384 - 1) && decltype(n)::RawMax == 2 * 16384);
+    static_assert(std::is_same_v<decltype(n)::storage_type, std::int32_t>);
+    assert(static_cast<double>(n) == -1.5);
+
+    // Clamping and dropping fractional bits
+    assert(gain::clamp(fixed_q16_16(100.0f)).raw == gain::RawMax);
+    assert(static_cast<double>(fixp::rescale<4>(offset)) == 6000.25);
+    assert(fixp::rescale<0>(offset) == adc::from_raw(6000));
+
+    // Going back to a plain format is only allowed if the range fits
+    const fixed_q16_16 out = offset.to<fixed_q16_16>();
+    assert(static_cast<float>(out) == 6000.25f);
+
+    const auto full = fixp::as_ranged(fixed_q8_8(3.5f)) * fixp::as_ranged(fixed_q8_8(-2.0f));
+    static_assert(std::is_same_v<decltype(full)::storage_type, std::int32_t>);
+    assert(static_cast<double>(full) == -7.0);
+
+    std::cout << "ranged: OK" << std::endl;
+
+    return 0;
+}
+
+int
+test_wide()
+{
+    using namespace fixp::literals;
+    using T = fixed_q32_32;
+
+    static_assert(T::Scale == static_cast<__int128>(1) << 32);
+    static_assert(T::FracMask == 0xffffffff);
+    static_assert((1.5_q32).raw == 0x180000000);
+    static_assert((-2147483647.75_q32).raw == -0x7fffffffc0000000);
+
+    // Products and quotients are exact to the last bit of Q32.32,
+    // well beyond what a double can check
+    const T a = 123456.789;
+    const T b = -0.000123;
+    const T big = 1.0e9;
+
+    const auto mul_exact = [](T x, T y) {
+        return static_cast<std::int64_t>((static_cast<__int128>(x.raw) * y.raw) >> 32);
+    };
+
+    assert((a * b).raw == mul_exact(a, b));
+    assert((big * T(2)).raw == big.raw * 2);
+    assert(std::abs(static_cast<double>(a * b) - static_cast<double>(a) * static_cast<double>(b)) < 1e-9);
+
+    assert((a / b).raw == static_cast<std::int64_t>((static_cast<__int128>(a.raw) << 32) / b.raw));
+    assert(std::abs(static_cast<double>(T(1) / T(3)) - 1.0 / 3.0) < 1e-9);
+
+    // Small values keep their precision next to large ones
+    const T acc = big + T(2.5e-10);
+    assert(acc.raw == big.raw + 1);
+
+    assert(fixp::to_string(T(-1.5)) == "-1.5");
+    assert(fixp::to_string(1.5_q32 * T(2)) == "3");
+
+    char str[32];
+    fixp::to_cstring(T(5.25), str, sizeof(str));
+    assert(std::string(str) == "5.25");
+
+    assert(std::abs(static_cast<double>(fixp::sqrt(T(2))) - std::numbers::sqrt2) < 1e-6);
+    assert(std::abs(static_cast<double>(fixp::sin(T(0.5))) - std::sin(0.5)) < 1e-3);
+
+    // Mixed arithmetic with 64 bit formats widens to __int128
+    static_assert(std::is_same_v<fixp::product_t<T, fixed_q16_16>, fixp::fixed<48, __int128, __int128>>);
+    assert(T(fixed_q16_16(3.5f) * T(2)) == T(7));
+
+    std::cout << "wide: " << fixp::to_string(a * b) << std::endl;
+    std::cout << "wide: OK" << std::endl;
+
+    return 0;
+}
+
+int
+test_unsigned()
+{
+    static_assert(fixed_uq0_16::Scale == 65536);
+    static_assert(fixed_uq0_16::FracMask == 0xffff);
+    static_assert(fixed_uq8_8::IntegralBits == 8);
+
+    // One more bit of precision than Q0.15
+    const fixed_uq0_16 p = 0.75f;
+    const fixed_uq0_16 q = 0.5f;
+    assert(p.raw == 49152);
+    assert((p * q).raw == 24576);
+    assert((q / p).raw == 43690);
+
+    // Logical shifts, no sign extension near the top of the range
+    const fixed_uq8_8 big = 200.5f;
+    assert(static_cast<float>(big) == 200.5f);
+    assert(static_cast<float>(big * fixed_uq8_8(1.25f)) == 250.625f);
+    assert(fixp::to_string(big) == "200.5");
+
+    // Differences of unsigned values are signed
+    static_assert(std::is_same_v<fixp::difference_t<fixed_uq0_8, fixed_uq8_8>, fixp::fixed<8, std::int32_t, std::int32_t>>);
+    static_assert(std::is_same_v<fixp::sum_t<fixed_uq0_8, fixed_uq8_8>, fixp::fixed<8, std::uint32_t, std::uint32_t>>);
+    static_assert(std::is_same_v<fixp::product_t<fixed_uq0_8, fixed_uq0_16>, fixp::fixed<24, std::uint32_t, std::uint32_t>>);
+    static_assert(std::is_same_v<fixp::product_t<fixed_uq0_16, fixed_q0_15>, fixp::fixed<31, std::int32_t, std::int32_t>>);
+    assert(static_cast<float>(fixed_uq0_8(0.25f) - fixed_uq8_8(1.0f)) == -0.75f);
+    assert(static_cast<float>(p * fixed_q0_15(-0.5f)) == -0.375f);
+
+    // Conversions to signed formats
+    assert(fixed_q0_15(p).raw == 24576);
+    assert(fixp::saturate_cast<fixed_q8_8>(big) == fixed_q8_8::from_raw(std::numeric_limits<std::int16_t>::max()));
+    assert(fixp::saturate_cast<fixed_q8_8>(fixed_uq8_8(100.25f)) == fixed_q8_8(100.25f));
+    assert(fixp::saturate_cast<fixed_uq0_8>(fixed_q4_12(-1.0f)).raw == 0);
+    assert(fixp::saturate_cast<fixed_uq0_8>(fixed_q4_12(0.5f)).raw == 128);
+    assert(fixp::saturate_cast<fixed_q16_16>(big) == fixed_q16_16(200.5f));
+
+    // Saturating bulk kernels, long enough to cover the vector paths
+    constexpr std::size_t N = 100;
+
+    fixed_uq0_8 a8[N], b8[N], out8[N];
+    fixed_q0_15 a16[N], b16[N], out16[N];
+    fixed_q8_8 signed_out[N];
+
+    for (std::size_t i = 0; i < N; i++) {
+        a8[i] = fixed_uq0_8::from_raw(static_cast<std::uint8_t>(i * 37));
+        b8[i] = fixed_uq0_8::from_raw(static_cast<std::uint8_t>(i * 91 + 13));
+        a16[i] = fixed_q0_15::from_raw(static_cast<std::int16_t>(i * 7919 - 20000));
+        b16[i] = fixed_q0_15::from_raw(static_cast<std::int16_t>(i * 4001 + 3));
+    }
+
+    fixp::add_saturate(a8, b8, out8, N);
+    for (std::size_t i = 0; i < N; i++) {
+        assert(out8[i].raw == std::min(a8[i].raw + b8[i].raw, 255));
+    }
+
+    fixp::sub_saturate(a8, b8, out8, N);
+    for (std::size_t i = 0; i < N; i++) {
+        assert(out8[i].raw == std::max(a8[i].raw - b8[i].raw, 0));
+    }
+
+    fixp::add_saturate(a16, b16, out16, N);
+    for (std::size_t i = 0; i < N; i++) {
+        assert(out16[i].raw == std::clamp(a16[i].raw + b16[i].raw, -32768, 32767));
+    }
+
+    fixp::sub_saturate(a16, b16, out16, N);
+    for (std::size_t i = 0; i < N; i++) {
+        assert(out16[i].raw == std::clamp(a16[i].raw - b16[i].raw, -32768, 32767));
+    }
+
+    fixed_uq8_8 wide[N];
+    for (std::size_t i = 0; i < N; i++) {
+        wide[i] = fixed_uq8_8::from_raw(static_cast<std::uint16_t>(i * 650));
+    }
+
+    fixp::convert(wide, signed_out, N);
+    for (std::size_t i = 0; i < N; i++) {
+        assert(signed_out[i].raw == std::min<int>(wide[i].raw, 32767));
+    }
+
+    std::cout << "unsigned: OK" << std::endl;
+
+    return 0;
+}
+
+template<fixp::is_fixed T>
+static void
+check_divider()
+{
+    using Storage = typename T::storage_type;
+    using limits = std::numeric_limits<Storage>;
+
+    const Storage divisors[] = {
+        1, 2, 3, 7, 100, static_cast<Storage>(limits::max() / 3), limits::max(), limits::min(),
+        static_cast<Storage>(limits::min() == 0 ? 5 : -1), static_cast<Storage>(limits::min() == 0 ? 64 : -3),
+    };
+
+    constexpr std::size_t N = 257;
+    T in[N], out[N];
+
+    for (std::size_t i = 0; i < N; i++) {
+        in[i] = T::from_raw(static_cast<Storage>(i * 0x9e3779b97f4a7c15ull));
+    }
+
+    in[0] = T::from_raw(limits::max());
+    in[1] = T::from_raw(limits::min());
+
+    for (Storage raw : divisors) {
+        if (raw == 0) {
+            continue;
+        }
+
+        const T d = T::from_raw(raw);
+        const fixp::divider<T> divider(d);
+
+        divider.divide(in, out, N);
+
+        for (std::size_t i = 0; i < N; i++) {
+            // limits::min() / -1 overflows operator/ as well
+            if (limits::min() != 0 && raw == static_cast<Storage>(-1) && in[i].raw == limits::min()) {
+                continue;
+            }
+
+            assert((in[i] / divider).raw == (in[i] / d).raw);
+            assert(out[i] == in[i] / d);
+        }
+    }
+}
+
+int
+test_divider()
+{
+    check_divider<fixed_q8_8>();
+    check_divider<fixed_q0_15>();
+    check_divider<fixed_q16_16>();
+    check_divider<fixed_q32_32>();
+    check_divider<fixed_uq0_16>();
+    check_divider<fixed_uq0_8>();
+    // a.raw << FracBits wraps a 16 bit intermediate but not the int
+    // operator/ promotes it to, which also makes the division signed
+    check_divider<fixp::fixed<8, std::int16_t, std::int16_t>>();
+    check_divider<fixp::fixed<16, std::uint16_t, std::uint16_t>>();
+
+    std::cout << "divider: OK" << std::endl;
+
+    return 0;
+}
+
+template<fixp::is_fixed T>
+static void
+check_newton_div()
+{
+    using Storage = typename T::storage_type;
+    // operator/ works in the intermediate type after promotion
+    using Numerator = std::common_type_t<int, typename T::intermediate_type>;
+    using limits = std::numeric_limits<Storage>;
+
+    constexpr std::size_t N = 4099;
+    T a[N], b[N], exact[N], faithful[N];
+
+    for (std::size_t i = 0; i < N; i++) {
+        a[i] = T::from_raw(static_cast<Storage>(i * 0x9e3779b97f4a7c15ull >> (i % 23)));
+        b[i] = T::from_raw(static_cast<Storage>(i * 0xc2b2ae3d27d4eb4full >> (i % 31)));
+
+        // Powers of two, including the extremes
+        if (i % 5 == 0) {
+            b[i] = T::from_raw(static_cast<Storage>(Storage { 1 } << (i % (T::TotalBits - 1))));
+        }
+
+        if (b[i].raw == 0 || (limits::min() != 0 && a[i].raw == limits::min() && b[i].raw == static_cast<Storage>(-1))) {
+            b[i] = T::from_raw(1);
+        }
+    }
+
+    a[0] = T::from_raw(limits::max());
+    a[1] = T::from_raw(limits::min());
+    b[2] = T::from_raw(limits::max());
+    b[3] = T::from_raw(limits::min() == 0 ? 1 : limits::min());
+
+    fixp::div(a, b, exact, N);
+    fixp::div<fixp::division_accuracy::faithful>(a, b, faithful, N);
+
+    for (std::size_t i = 0; i < N; i++) {
+        const T expected = a[i] / b[i];
+        const Storage error = static_cast<Storage>(faithful[i].raw - expected.raw);
+
+        assert(exact[i] == expected);
+        assert(error == 0 || error == 1 || error == static_cast<Storage>(-1));
+    }
+
+    if constexpr (2 * T::FracBits < sizeof(Numerator) * 8 - 1) {
+        fixp::reciprocal(b, exact, N);
+
+        for (std::size_t i = 0; i < N; i++) {
+            const Numerator one = static_cast<Numerator>(1) << (2 * T::FracBits);
+            assert(exact[i].raw == static_cast<Storage>(one / b[i].raw));
+        }
+    }
+}
+
+int
+test_newton()
+{
+    check_newton_div<fixed_q8_8>();
+    check_newton_div<fixed_q4_12>();
+    check_newton_div<fixed_q0_15>();
+    check_newton_div<fixed_q16_16>();
+    check_newton_div<fixed_q32_32>();
+    check_newton_div<fixed_uq0_16>();
+    check_newton_div<fixed_uq8_8>();
+    check_newton_div<fixp::fixed<8, std::int16_t, std::int16_t>>();
+    check_newton_div<fixp::fixed<16, std::uint16_t, std::uint16_t>>();
+
+    const fixed_q16_16 x[] = { 3.0f, -0.25f, 100.0f };
+    fixed_q16_16 inv[3];
+    fixp::reciprocal(x, inv, 3);
+    assert(inv[1] == fixed_q16_16(-4.0f));
+    assert(inv[2] == fixed_q16_16::from_raw(655));
+
+    std::cout << "newton: OK" << std::endl;
+
+    return 0;
+}
+
+template<fixp::is_fixed T>
+static void
+check_fma()
+{
+    using Storage = typename T::storage_type;
+    using Intermediate = typename T::intermediate_type;
+
+    constexpr std::size_t N = 203;
+    T a[N], b[N], c[N], nearest[N], truncated[N], scaled[N];
+
+    for (std::size_t i = 0; i < N; i++) {
+        a[i] = T::from_raw(static_cast<Storage>(i * 0x9e3779b9u >> (i % 13)));
+        b[i] = T::from_raw(static_cast<Storage>(i * 0x85ebca6bu >> (i % 17)));
+        c[i] = T::from_raw(static_cast<Storage>(i * 0xc2b2ae35u));
+    }
+
+    fixp::fma(a, b, c, nearest, N);
+    fixp::fma<fixp::rounding::truncate>(a, b, c, truncated, N);
+    fixp::fma(a, b[7], c, scaled, N);
+
+    for (std::size_t i = 0; i < N; i++) {
+        const Intermediate exact = static_cast<Intermediate>(a[i].raw) * b[i].raw
+            + (static_cast<Intermediate>(c[i].raw) << T::FracBits);
+
+        // Round to nearest, ties to even, in long double
+        const long double q = static_cast<long double>(exact) / static_cast<long double>(Intermediate { 1 } << T::FracBits);
+        const Storage expected = static_cast<Storage>(static_cast<Intermediate>(std::nearbyint(q)));
+
+        assert(nearest[i].raw == expected);
+        assert(nearest[i] == fixp::fma(a[i], b[i], c[i]));
+        assert(truncated[i].raw == static_cast<Storage>(exact >> T::FracBits));
+        assert(scaled[i] == fixp::fma(a[i], b[7], c[i]));
+    }
+}
+
+int
+test_fma()
+{
+    // A single rounding at the end: 0.75 * 2^-8 is below an LSB of Q8.8
+    // and lost by a * b + c, but not by fma
+    const fixed_q8_8 a = fixed_q8_8::from_raw(3);
+    const fixed_q8_8 b = 0.25f;
+    const fixed_q8_8 c = fixed_q8_8::from_raw(1);
+
+    assert((a * b + c).raw == 1);
+    assert(fixp::fma(a, b, c).raw == 2);
+    assert(fixp::fma<fixp::rounding::truncate>(a, b, c).raw == 1);
+
+    // Ties go to even
+    assert(fixp::fma(fixed_q8_8::from_raw(1), fixed_q8_8(0.5f), fixed_q8_8::from_raw(0)).raw == 0);
+    assert(fixp::fma(fixed_q8_8::from_raw(3), fixed_q8_8(0.5f), fixed_q8_8::from_raw(0)).raw == 2);
+    assert(fixp::fma(fixed_q8_8::from_raw(-1), fixed_q8_8(0.5f), fixed_q8_8::from_raw(0)).raw == 0);
+
+    check_fma<fixed_q8_8>();
+    check_fma<fixed_q0_15>();
+    check_fma<fixed_q16_16>();
+
+    std::cout << "fma: OK" << std::endl;
+
+    return 0;
+}
+
+template<typename T>
+void
+check_poly()
+{
+    using Storage = typename T::storage_type;
+    using P = fixp::poly<0.5, -1.25, 0.375, 0.0625, -0.03125>;
+
+    constexpr double Lsb = 1.0 / static_cast<double>(T::Scale);
+    constexpr std::size_t N = 203;
+    T x[N], horner[N], estrin[N];
+
+    // Inputs on [-2, 2), where the partial sums stay in range
+    for (std::size_t i = 0; i < N; i++) {
+        x[i] = T(-2.0 + 4.0 * static_cast<double>(i) / N);
+    }
+
+    fixp::evaluate<P>(x, horner, N);
+    fixp::evaluate<P, fixp::poly_scheme::estrin>(x, estrin, N);
+
+    // With guard bits each partial result is off by far less than
+    // an LSB of T, so a single rounding gives at most half an LSB
+    // plus a little. Without, every step can lose one
+    const double tolerance = fixp::detail::poly_format<T>::GuardBits > 0 ? 0.51 * Lsb : 5.0 * Lsb;
+
+    for (std::size_t i = 0; i < N; i++) {
+        const double v = static_cast<double>(x[i]);
+        const double expected = 0.5 + v * (-1.25 + v * (0.375 + v * (0.0625 + v * -0.03125)));
+
+        assert(horner[i] == P::evaluate(x[i]));
+        assert(estrin[i] == P::evaluate<fixp::poly_scheme::estrin>(x[i]));
+        assert(std::abs(static_cast<double>(horner[i]) - expected) <= tolerance);
+        assert(std::abs(static_cast<double>(estrin[i]) - expected) <= tolerance);
+        assert(std::abs(static_cast<double>(P::evaluate<fixp::poly_scheme::horner, fixp::rounding::truncate>(x[i])) - expected) <= tolerance + Lsb);
+    }
+
+    // Constants and odd degrees
+    assert((fixp::poly<0.25>::evaluate(x[5]) == T(0.25)));
+    assert((fixp::poly<0.0, 1.0>::evaluate<fixp::poly_scheme::estrin>(x[5]) == x[5]));
+    assert((fixp::poly<1.0, 1.0, 1.0>{}(T::from_raw(Storage { 0 })) == T(1.0)));
+}
+
+int
+test_poly()
+{
+    check_poly<fixed_q4_12>();
+    check_poly<fixed_q8_8>();
+    check_poly<fixed_q16_16>();
+    check_poly<fixed_q32_32>();
+
+    // sin and cos are evaluated at full precision now, so stay close
+    // to the error of the approximation itself
+    for (double x = -6.0; x < 6.0; x += 0.01) {
+        assert(std::abs(static_cast<double>(fixp::sin(fixed_q16_16(x))) - std::sin(x)) < 2e-3);
+        assert(std::abs(static_cast<double>(fixp::cos(fixed_q16_16(x))) - std::cos(x)) < 2e-3);
+        assert(std::abs(static_cast<double>(fixp::sin(fixed_q4_12(x))) - std::sin(x)) < 3e-3);
+    }
+
+    std::cout << "poly: OK" << std::endl;
+
+    return 0;
+}
+
+template<typename T>
+void
+check_expr()
+{
+    using Storage = typename T::storage_type;
+
+    constexpr std::size_t N = 203;
+    std::vector<T> a(N), x(N), b(N), y(N), z(N);
+
+    // Values on [0, 2), which keeps everything below in range for
+    // signed and unsigned formats alike
+    for (std::size_t i = 0; i < N; i++) {
+        a[i] = T::from_raw(static_cast<Storage>(i * 0x9e3779b9u % (2u << T::FracBits)));
+        x[i] = T::from_raw(static_cast<Storage>(i * 0x85ebca6bu % (2u << T::FracBits)));
+        b[i] = T::from_raw(static_cast<Storage>(i * 0xc2b2ae35u % (2u << T::FracBits)));
+    }
+
+    const T k = 0.75f;
+
+    fixp::expr::assign(y.data(), fixp::lazy(a) * fixp::lazy(x) + fixp::lazy(b));
+    fixp::expr::assign(z.data(), -(k * fixp::lazy(a.data(), N) - fixp::lazy(b)) / T(2.0f));
+
+    for (std::size_t i = 0; i < N; i++) {
+        assert(y[i] == a[i] * x[i] + b[i]);
+        assert(z[i] == -(k * a[i] - b[i]) / T(2.0f));
+    }
+
+    // In place, y = y * k + b
+    fixp::expr::assign(y.data(), fixp::lazy(y) * k + fixp::lazy(b));
+
+    for (std::size_t i = 0; i < N; i++) {
+        assert(y[i] == (a[i] * x[i] + b[i]) * k + b[i]);
+    }
+}
+
+int
+test_expr()
+{
+    check_expr<fixed_q4_12>();
+    check_expr<fixed_q16_16>();
+    check_expr<fixed_uq8_8>();
+
+    std::cout << "expr: OK" << std::endl;
+
+    return 0;
+}
+
+int
+test_soa()
+{
+    using vec3 = fixp::linalg::vec3<fixed_q16_16>;
+
+    fixp::soa<vec3> position { { 1.0f, 2.0f, 3.0f }, { -1.5f, 0.25f, 4.0f } };
+    position.push_back({ 0.5f, 0.5f, -0.5f });
+
+    assert(position.size() == 3);
+    assert(position[1] == vec3(-1.5f, 0.25f, 4.0f));
+
+    // Components are contiguous, aligned and zero padded
+    for (std::size_t c = 0; c < 3; c++) {
+        assert(reinterpret_cast<std::uintptr_t>(position.component(c)) % fixp::DefaultAlignment == 0);
+        assert(position.padded_size() * sizeof(fixed_q16_16) % fixp::DefaultAlignment == 0);
+
+        for (std::size_t i = position.size(); i < position.padded_size(); i++) {
+            assert(position.component(c)[i].raw == 0);
+        }
+    }
+
+    assert(position.component(1)[2] == fixed_q16_16(0.5f));
+
+    // AoS style access through the proxies
+    position[2][1] = 1.0f;
+    position[0] += vec3(1.0f, 1.0f, 1.0f);
+    assert(position[0] == vec3(2.0f, 3.0f, 4.0f));
+    assert(position[2] == vec3(0.5f, 1.0f, -0.5f));
+
+    std::size_t visited = 0;
+    for (vec3 v : std::as_const(position)) {
+        assert(v == position[visited++]);
+    }
+    assert(visited == 3);
+
+    for (auto v : position) {
+        v = vec3(v) * fixed_q16_16(2.0f);
+    }
+    assert(position[1] == vec3(-3.0f, 0.5f, 8.0f));
+
+    // Bulk operations match element by element
+    const std::size_t N = 37;
+    fixp::soa<vec3> p(N), v(N), scratch;
+    for (std::size_t i = 0; i < N; i++) {
+        p[i] = vec3(fixed_q16_16(0.25f * i), fixed_q16_16(-0.5f * i), fixed_q16_16(1.0f));
+        v[i] = vec3(fixed_q16_16(0.125f), fixed_q16_16(0.0625f * i), fixed_q16_16(-0.75f * i));
+    }
+
+    const fixp::soa<vec3> p0 = p;
+    const fixed_q16_16 dt = 0.01f;
+
+    fixp::fma(v, dt, p, p);
+    fixp::add(p0, v, scratch);
+
+    fixed_q16_16 d[N];
+    fixp::dot(p0, v, d);
+
+    for (std::size_t i = 0; i < N; i++) {
+        for (std::size_t c = 0; c < 3; c++) {
+            assert(p[i][c] == fixp::fma(v[i][c], dt, p0[i][c]));
+            assert(scratch[i][c] == p0[i][c] + v[i][c]);
+        }
+
+        assert(d[i] == fixp::linalg::dot(p0[i], vec3(v[i])));
+    }
+
+    fixp::scale(v, fixed_q16_16(2.0f), v);
+    fixp::sub(v, v, scratch);
+    assert(v[5] == vec3(fixed_q16_16(0.25f), fixed_q16_16(0.625f), fixed_q16_16(-7.5f)));
+    assert(scratch[5] == vec3());
+
+    scratch.resize(2);
+    assert(scratch.size() == 2 && scratch.component(0)[5].raw == 0);
+
+    std::cout << "soa: OK" << std::endl;
+
+    return 0;
+}
+
+template<typename T>
+void
+check_array()
+{
+    using Storage = typename T::storage_type;
+
+    // Sizes either side of a whole cache line
+    for (std::size_t n : { 0, 1, 31, 32, 33, 100 }) {
+        fixp::array<T> a(n), b(n), c(n), out;
+
+        assert(reinterpret_cast<std::uintptr_t>(a.data()) % fixp::DefaultAlignment == 0);
+        assert(a.padded_size() * sizeof(T) % fixp::DefaultAlignment == 0);
+        assert(a.padded_size() >= n && a.padded_size() < n + fixp::DefaultAlignment / sizeof(T) + 1);
+
+        for (std::size_t i = 0; i < n; i++) {
+            a[i] = T::from_raw(static_cast<Storage>(i * 0x9e3779b9u >> 7));
+            b[i] = T::from_raw(static_cast<Storage>(i * 0x85ebca6bu >> 5));
+            c[i] = T::from_raw(static_cast<Storage>(i * 0xc2b2ae35u >> 11));
+        }
+
+        fixp::add_saturate(a, b, out);
+        assert(out.size() == n);
+        for (std::size_t i = 0; i < n; i++) {
+            T expected;
+            fixp::add_saturate(&a[i], &b[i], &expected, 1);
+            assert(out[i] == expected);
+        }
+
+        fixp::fma(a, b, c, out);
+        for (std::size_t i = 0; i < n; i++) {
+            assert(out[i] == fixp::fma(a[i], b[i], c[i]));
+        }
+
+        fixp::fma(a, T(0.5f), c, out);
+        for (std::size_t i = 0; i < n; i++) {
+            assert(out[i] == fixp::fma(a[i], T(0.5f), c[i]));
+        }
+
+        std::size_t visited = 0;
+        for (const T& x : a) {
+            assert(x == a[visited++]);
+        }
+        assert(visited == n);
+    }
+}
+
+int
+test_array()
+{
+    check_array<fixed_q4_12>();
+    check_array<fixed_q16_16>();
+    check_array<fixed_uq0_8>();
+
+    fixp::array<fixed_q4_12> x { 0.5f, -0.25f, 1.0f }, y;
+    fixp::evaluate<fixp::poly<1.0, 2.0>>(x, y);
+    assert(y.size() == 3 && y[0] == fixed_q4_12(2.0f) && y[1] == fixed_q4_12(0.5f) && y[2] == fixed_q4_12(3.0f));
+
+    // Shrinking zeroes what becomes padding
+    y.resize(1);
+    assert(y[1].raw == 0 && y[2].raw == 0);
+
+    std::span<const fixed_q4_12> view = std::as_const(x);
+    assert(view.size() == 3 && view[1] == fixed_q4_12(-0.25f));
+
+    std::cout << "array: OK" << std::endl;
+
+    return 0;
+}
+
+int
+test_view()
+{
+    static_assert(std::is_trivially_copyable_v<fixed_q4_12> && std::is_standard_layout_v<fixed_q4_12>);
+    static_assert(std::is_trivially_copyable_v<fixed_q32_32> && std::is_trivial_v<fixed_uq0_8>);
+
+    std::int16_t samples[] = { 4096, -2048, 1, 0x7fff };
+    const std::span<fixed_q4_12> x = fixp::span_view<fixed_q4_12>(samples);
+
+    assert(x.size() == 4);
+    assert(static_cast<void*>(x.data()) == static_cast<void*>(samples));
+    assert(x[0] == fixed_q4_12(1.0f) && x[1] == fixed_q4_12(-0.5f) && x[2].raw == 1);
+
+    // Writes go straight to the buffer
+    x[3] = 0.25f;
+    assert(samples[3] == 1024);
+
+    const std::int32_t* words = reinterpret_cast<const std::int32_t*>(samples);
+    const std::span<const fixed_q16_16> y = fixp::span_view<fixed_q16_16>(words, 2);
+    assert(y.size() == 2 && y[0].raw == words[0]);
+
+    std::vector<fixed_q0_15> out(3, fixed_q0_15(0.5f));
+    const std::span<std::int16_t> raw = fixp::raw_view(out);
+    assert(raw.size() == 3 && raw[2] == 0x4000);
+
+    fixp::array<fixed_q4_12> padded { 1.0f, 2.0f };
+    assert(fixp::raw_view(std::as_const(padded))[1] == 8192);
+
+    std::cout << "view: OK" << std::endl;
+
+    return 0;
+}
+
+int
+test_dataset()
+{
+    const std::string path = "fixp-test-dataset.fxpd";
+
+    std::vector<fixed_q4_12> values(1000);
+    for (std::size_t i = 0; i < values.size(); i++) {
+        values[i] = fixed_q4_12::from_raw(static_cast<std::int16_t>(i * 0x9e37u));
+    }
+
+    assert(fixp::write_dataset<fixed_q4_12>(path.c_str(), values));
+
+    {
+        auto dataset = fixp::mapped_dataset<fixed_q4_12>::open(path.c_str());
+        assert(dataset.has_value());
+        assert(dataset->size() == values.size());
+        assert(reinterpret_cast<std::uintptr_t>(dataset->values().data()) % 64 == 0);
+
+        for (std::size_t i = 0; i < values.size(); i++) {
+            assert((*dataset)[i] == values[i]);
+        }
+
+        // Moving keeps the mapping alive
+        auto moved = std::move(*dataset);
+        assert(moved.size() == values.size() && moved[999] == values[999]);
+    }
+
+    // Same storage, different format
+    assert(fixp::mapped_dataset<fixed_q8_8>::open(path.c_str()).error() == fixp::dataset_error::format_mismatch);
+    assert(fixp::mapped_dataset<fixed_uq0_16>::open(path.c_str()).error() == fixp::dataset_error::format_mismatch);
+    assert(fixp::mapped_dataset<fixed_q4_12>::open("fixp-test-missing.fxpd").error() == fixp::dataset_error::io);
+
+    // Cut the payload short
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        fixp::dataset_header header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        header.count += 1;
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    assert(fixp::mapped_dataset<fixed_q4_12>::open(path.c_str()).error() == fixp::dataset_error::truncated);
+
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << "not a dataset, but long enough to hold a header of sixty-four bytes";
+    }
+    assert(fixp::mapped_dataset<fixed_q4_12>::open(path.c_str()).error() == fixp::dataset_error::bad_header);
+
+    std::remove(path.c_str());
+
+    std::cout << "dataset: OK" << std::endl;
+
+    return 0;
+}
+
+template<typename T, std::size_t Bits>
+void
+check_bitpacked()
+{
+    using Storage = typename T::storage_type;
+
+    // Every value representable in Bits bits, including both ends
+    constexpr std::int64_t Lo = fixp::is_signed_integer<Storage> ? -(std::int64_t { 1 } << (Bits - 1)) : 0;
+    constexpr std::int64_t Hi = fixp::is_signed_integer<Storage> ? (std::int64_t { 1 } << (Bits - 1)) - 1
+                                                                 : (std::int64_t { 1 } << Bits) - 1;
+
+    // Sizes around the block size
+    for (std::size_t n : { 0, 1, 255, 256, 257, 1000 }) {
+        std::vector<T> values(n), unpacked(n);
+        for (std::size_t i = 0; i < n; i++) {
+            const std::int64_t r = i == 0 ? Lo : i == 1 ? Hi : Lo + static_cast<std::int64_t>(i * 0x9e3779b9u % static_cast<std::uint64_t>(Hi - Lo + 1));
+            values[i] = T::from_raw(static_cast<Storage>(r));
+        }
+
+        fixp::bitpacked<T, Bits> p(values);
+        assert(p.size() == n);
+        assert(p.size_bytes() == fixp::packed_words<Bits>(n) * 4);
+
+        p.unpack(unpacked.data());
+        for (std::size_t i = 0; i < n; i++) {
+            assert(unpacked[i] == values[i]);
+            assert(p[i] == values[i]);
+        }
+
+        // Single element writes leave the neighbours alone
+        for (std::size_t i = 0; i < n; i += 7) {
+            p.set(i, values[n - 1 - i]);
+        }
+        for (std::size_t i = 0; i < n; i++) {
+            assert(p[i] == (i % 7 == 0 ? values[n - 1 - i] : values[i]));
+        }
+    }
+}
+
+int
+test_bitpacked()
+{
+    check_bitpacked<fixed_q4_12, 12>();
+    check_bitpacked<fixed_q4_12, 10>();
+    check_bitpacked<fixed_q0_15, 16>();
+    check_bitpacked<fixed_q16_16, 20>();
+    check_bitpacked<fixed_q16_16, 32>();
+    check_bitpacked<fixed_q16_16, 1>();
+    check_bitpacked<fixed_uq0_16, 12>();
+    check_bitpacked<fixed_uq0_8, 3>();
+
+    // 12 bit samples take three quarters of the space
+    const std::vector<fixed_q4_12> samples(1024, fixed_q4_12(0.5f));
+    assert((fixp::bitpacked<fixed_q4_12, 12>(samples).size_bytes() == samples.size() * sizeof(fixed_q4_12) * 3 / 4));
+
+    std::cout << "bitpacked: OK" << std::endl;
+
+    return 0;
+}
+
+template<typename T>
+void
+check_codec()
+{
+    using Storage = typename T::storage_type;
+
+    const auto round_trip = [](const std::vector<T>& values) {
+        const std::vector<std::uint32_t> encoded = fixp::encode<T>(values);
+        assert(encoded.size() <= fixp::max_encoded_words(values.size()));
+
+        const std::vector<T> decoded = fixp::decode<T>(encoded).value();
+        assert(decoded.size() == values.size());
+        for (std::size_t i = 0; i < values.size(); i++) {
+            assert(decoded[i].raw == values[i].raw);
+        }
+
+        return encoded.size();
+    };
+
+    for (std::size_t n : { 0, 1, 9, 255, 256, 257, 1000 }) {
+        // Slow ramp, picks delta coding
+        std::vector<T> values(n);
+        for (std::size_t i = 0; i < n; i++) {
+            values[i] = T::from_raw(static_cast<Storage>(std::numeric_limits<Storage>::max() - static_cast<Storage>(i * 3 % 100)));
+        }
+        round_trip(values);
+
+        // Noise over the whole range, including both ends, so neither
+        // coding saves anything and deltas wrap around
+        for (std::size_t i = 0; i < n; i++) {
+            const auto r = static_cast<Storage>(i * 0x9e3779b9u);
+            values[i] = T::from_raw(i % 5 == 0 ? std::numeric_limits<Storage>::min() : i % 5 == 1 ? std::numeric_limits<Storage>::max() : r);
+        }
+        round_trip(values);
+
+        // Constant blocks need only their header
+        std::fill(values.begin(), values.end(), T::from_raw(std::numeric_limits<Storage>::min()));
+        assert(round_trip(values) == (n + 255) / 256 * 2);
+    }
+}
+
+int
+test_codec()
+{
+    check_codec<fixed_q16_16>();
+    check_codec<fixed_q4_12>();
+    check_codec<fixed_uq0_16>();
+    check_codec<fixed_uq0_8>();
+
+    // A slowly changing signal pushed in odd sized chunks
+    constexpr std::size_t N = 4096;
+    std::vector<fixed_q16_16> signal(N);
+    for (std::size_t i = 0; i < N; i++) {
+        signal[i] = fixed_q16_16(100.0f + 10.0f * std::sin(static_cast<float>(i) / 2000.0f));
+    }
+
+    std::vector<std::uint32_t> encoded;
+    fixp::block_encoder<fixed_q16_16> encoder(encoded);
+    for (std::size_t i = 0; i < N; i += 100) {
+        encoder.push(std::span(signal).subspan(i, std::min<std::size_t>(100, N - i)));
+    }
+    encoder.finish();
+
+    // Steps 8 apart are under 2^12 LSB, so the stream is under half size
+    assert(encoded.size() * 2 < N);
+
+    fixp::block_decoder<fixed_q16_16> decoder(encoded);
+    std::vector<fixed_q16_16> block(256);
+    std::size_t at = 0;
+    while (!decoder.done()) {
+        const std::size_t count = decoder.next(block.data()).value();
+        for (std::size_t i = 0; i < count; i++) {
+            assert(block[i] == signal[at + i]);
+        }
+        at += count;
+    }
+    assert(at == N);
+
+    // Malformed input is reported, not read past
+    assert(fixp::decode<fixed_q16_16>(std::span(encoded).first(1)).error() == fixp::codec_error::truncated);
+    assert(fixp::decode<fixed_q16_16>(std::span(encoded).first(encoded.size() - 1)).error() == fixp::codec_error::truncated);
+
+    std::vector<std::uint32_t> corrupt(encoded);
+    corrupt[0] = (corrupt[0] & ~0xffu) | 33;
+    assert(fixp::decode<fixed_q16_16>(corrupt).error() == fixp::codec_error::bad_header);
+
+    corrupt = encoded;
+    corrupt[0] |= 0x01000000u;
+    fixp::block_decoder<fixed_q16_16> rejecting(corrupt);
+    assert(rejecting.next(block.data()).error() == fixp::codec_error::bad_header);
+    assert(!rejecting.done());
+
+    std::cout << "codec: OK" << std::endl;
+
+    return 0;
+}
+
+int
+test_pipeline()
+{
+    using fixed = fixed_q0_15;
+    constexpr std::size_t Taps = 12;
+    constexpr std::size_t N = 10000;
+
+    std::array<fixed, Taps> coeffs;
+    for (std::size_t i = 0; i < Taps; i++) {
+        coeffs[i] = fixed::from_raw(static_cast<std::int16_t>(1000 * (i + 1)));
+    }
+
+    std::vector<fixed> in(N);
+    for (std::size_t i = 0; i < N; i++) {
+        in[i] = fixed::from_raw(static_cast<std::int16_t>(rand() % 20000 - 10000));
+    }
+
+    const auto halve = [](const fixed* in, fixed* out, std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            out[i] = in[i] * fixed(0.5f);
+        }
+    };
+
+    const auto twice = [](const fixed* in, fixed* out, std::size_t n) { fixp::add_saturate(in, in, out, n); };
+
+    // Reference: each stage over the whole array in turn
+    fixp::dsp::fir<fixed, Taps> reference(coeffs);
+    const auto expected = [&] {
+        std::vector<fixed> a(N), b(N);
+        reference.process(in.data(), a.data(), N);
+        halve(a.data(), b.data(), N);
+        twice(b.data(), a.data(), N);
+        return a;
+    };
+
+    const std::vector<fixed> first = expected();
+    const std::vector<fixed> second = expected();
+
+    // Chunks that do not divide N, so the last one is short
+    for (bool threaded : { false, true }) {
+        fixp::dsp::fir<fixed, Taps> filter(coeffs);
+        fixp::pipeline<fixed> p(300);
+        p.then(filter).then(halve).then(twice);
+
+        assert(p.size() == 3);
+        assert(p.chunk_values() == 320);
+
+        const auto run = [&](const fixed* in, fixed* out) {
+            if (threaded) {
+                p.run_threaded(in, out, N);
+            } else {
+                p.run(in, out, N);
+            }
+        };
+
+        std::vector<fixed> out(N);
+        run(in.data(), out.data());
+        assert(out == first);
+
+        // In place, with the filter carrying on where it left off
+        out = in;
+        run(out.data(), out.data());
+        assert(out == second);
+    }
+
+    // Nothing to do, and no stages
+    fixp::pipeline<fixed> empty;
+    std::vector<fixed> out(N);
+    empty.run_threaded(in.data(), out.data(), N);
+    assert(out == in);
+
+    std::cout << "pipeline: OK" << std::endl;
+
+    return 0;
+}
+
+template<typename T>
+void
+check_parallel()
+{
+    using Storage = typename T::storage_type;
+
+    // Several chunks, the last one short
+    constexpr std::size_t N = 100003;
+
+    // a and c in [-1, 1), b in [0.5, 1.5) so that it divides
+    constexpr std::int64_t One = std::int64_t { 1 } << T::FracBits;
+
+    std::vector<T> a(N), b(N), c(N);
+    for (std::size_t i = 0; i < N; i++) {
+        a[i] = T::from_raw(static_cast<Storage>(static_cast<std::int64_t>(i * 0x9e3779b9u % (2 * One)) - One));
+        b[i] = T::from_raw(static_cast<Storage>(static_cast<std::int64_t>(i * 0x85ebca6bu % One) + One / 2));
+        c[i] = T::from_raw(static_cast<Storage>(static_cast<std::int64_t>(i * 0xc2b2ae35u % (2 * One)) - One));
+    }
+
+    const auto same = [&](const auto& serial, const auto& parallel) {
+        std::vector<T> expected(N), out(N);
+        serial(expected.data());
+        parallel(out.data());
+        assert(out == expected);
+    };
+
+    same([&](T* out) { fixp::add_saturate(a.data(), b.data(), out, N); },
+         [&](T* out) { fixp::parallel::add_saturate(a.data(), b.data(), out, N); });
+    same([&](T* out) { fixp::sub_saturate(a.data(), b.data(), out, N); },
+         [&](T* out) { fixp::parallel::sub_saturate(a.data(), b.data(), out, N); });
+    same([&](T* out) { fixp::fma(a.data(), b.data(), c.data(), out, N); },
+         [&](T* out) { fixp::parallel::fma(a.data(), b.data(), c.data(), out, N); });
+    same([&](T* out) { fixp::fma(a.data(), b[7], c.data(), out, N); },
+         [&](T* out) { fixp::parallel::fma(a.data(), b[7], c.data(), out, N); });
+    same([&](T* out) { fixp::evaluate<fixp::poly<0.5, -0.25, 0.125>>(a.data(), out, N); },
+         [&](T* out) { fixp::parallel::evaluate<fixp::poly<0.5, -0.25, 0.125>>(a.data(), out, N); });
+    same([&](T* out) { fixp::div(a.data(), b.data(), out, N); },
+         [&](T* out) { fixp::parallel::div(a.data(), b.data(), out, N); });
+    same([&](T* out) { std::transform(a.begin(), a.end(), out, [](const T& x) { return fixp::sin(x); }); },
+         [&](T* out) { fixp::parallel::transform(a.data(), out, N, [](const T& x) { return fixp::sin(x); }); });
+
+    std::vector<float> f(N), g(N);
+    fixp::to_float(a.data(), f.data(), N);
+    fixp::parallel::to_float(a.data(), g.data(), N);
+    assert(f == g);
+    same([&](T* out) { fixp::from_float(f.data(), out, N); },
+         [&](T* out) { fixp::parallel::from_float(f.data(), out, N); });
+
+    // Reductions are exact, so must match a plain loop whatever the
+    // number of threads
+    std::int64_t sum = 0, dot = 0;
+    for (std::size_t i = 0; i < N; i++) {
+        sum += a[i].raw;
+        dot += static_cast<std::int64_t>(a[i].raw) * b[i].raw;
+    }
+
+    for (int threads : { 1, 2, 3, 8 }) {
+        #ifdef _OPENMP
+        omp_set_num_threads(threads);
+        #endif
+
+        assert(fixp::parallel::sum(a.data(), N).raw == sum);
+        assert(fixp::parallel::dot(a.data(), b.data(), N).raw
+               == std::clamp<std::int64_t>((dot + (std::int64_t { 1 } << (T::FracBits - 1))) >> T::FracBits,
+                                           std::numeric_limits<Storage>::min(), std::numeric_limits<Storage>::max()));
+    }
+}
+
+int
+test_parallel()
+{
+    check_parallel<fixed_q4_12>();
+    check_parallel<fixed_q16_16>();
+
+    // The default accumulators take large full scale sums
+    const std::vector<fixed_q0_15> loud(100000, fixed_q0_15::from_raw(20000));
+    assert(fixp::parallel::sum(loud.data(), loud.size()).raw == std::int64_t { 20000 } * 100000);
+    assert(fixp::parallel::dot(loud.data(), loud.data(), loud.size()).raw == std::numeric_limits<std::int16_t>::max());
+
+    std::vector<fixed_q0_15> alternating(loud);
+    for (std::size_t i = 1; i < alternating.size(); i += 2) {
+        alternating[i] = -alternating[i];
+    }
+    assert(fixp::parallel::dot(loud.data(), alternating.data(), loud.size()).raw == 0);
+
+    // Nothing to do
+    fixp::parallel::add_saturate<fixed_q4_12>(nullptr, nullptr, nullptr, 0);
+    assert(fixp::parallel::sum<fixed_q4_12>(nullptr, 0).raw == 0);
+
+    std::cout << "parallel: OK" << std::endl;
+
+    return 0;
+}
+
+int
+test_pool()
+{
+    fixp::task_pool pool(4);
+    assert(pool.size() == 4);
+
+    // Jobs of very different sizes, some of which split themselves up
+    // and wait from inside the pool
+    std::vector<std::int64_t> results(64, 0);
+    fixp::task_pool::group jobs;
+    for (std::size_t j = 0; j < results.size(); j++) {
+        pool.submit(jobs, [&pool, &results, j] {
+            if (j % 4 == 0) {
+                std::atomic<std::int64_t> total = 0;
+                fixp::task_pool::group parts;
+                for (std::int64_t p = 0; p < 16; p++) {
+                    pool.submit(parts, [&total, p] { total += p; });
+                }
+                pool.wait(parts);
+                results[j] = total;
+            } else {
+                std::int64_t total = 0;
+                for (std::size_t i = 0; i < j * 1000; i++) {
+                    total += static_cast<std::int64_t>(i % 7);
+                }
+                results[j] = total;
+            }
+        });
+    }
+    pool.wait(jobs);
+
+    for (std::size_t j = 0; j < results.size(); j++) {
+        std::int64_t expected = 0;
+        for (std::size_t i = 0; i < j * 1000; i++) {
+            expected += static_cast<std::int64_t>(i % 7);
+        }
+        assert(results[j] == (j % 4 == 0 ? 120 : expected));
+    }
+
+    // As an executor for the parallel kernels, with the same results
+    constexpr std::size_t N = 100003;
+    std::vector<fixed_q4_12> a(N), b(N), out(N), expected(N);
+    for (std::size_t i = 0; i < N; i++) {
+        a[i] = fixed_q4_12::from_raw(static_cast<std::int16_t>(i * 0x9e3779b9u % 8192) - 4096);
+        b[i] = fixed_q4_12::from_raw(static_cast<std::int16_t>(i * 0x85ebca6bu % 8192) - 4096);
+    }
+
+    fixp::parallel::fma(a.data(), b.data(), a.data(), expected.data(), N);
+    fixp::parallel::fma(a.data(), b.data(), a.data(), out.data(), N, pool);
+    assert(out == expected);
+
+    assert((fixp::parallel::dot<fixed_q4_12, std::int64_t>(a.data(), b.data(), N, pool)
+            == fixp::parallel::dot<fixed_q4_12, std::int64_t>(a.data(), b.data(), N)));
+
+    // An empty group is already done
+    fixp::task_pool::group none;
+    pool.wait(none);
+
+    std::cout << "pool: OK" << std::endl;
+
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
     if (argc < 2) {
@@ -203,6 +1971,56 @@ int main(int argc, char *argv[])
         return test_simd();
     } else if (command == "cstr") {
         return test_cstr();
+    } else if (command == "fir") {
+        return test_fir();
+    } else if (command == "biquad") {
+        return test_biquad();
+    } else if (command == "fft") {
+        return test_fft();
+    } else if (command == "complex") {
+        return test_complex();
+    } else if (command == "nco") {
+        return test_nco();
+    } else if (command == "conversion") {
+        return test_conversion();
+    } else if (command == "literals") {
+        return test_literals();
+    } else if (command == "mixed") {
+        return test_mixed();
+    } else if (command == "ranged") {
+        return test_ranged();
+    } else if (command == "wide") {
+        return test_wide();
+    } else if (command == "unsigned") {
+        return test_unsigned();
+    } else if (command == "divider") {
+        return test_divider();
+    } else if (command == "newton") {
+        return test_newton();
+    } else if (command == "fma") {
+        return test_fma();
+    } else if (command == "poly") {
+        return test_poly();
+    } else if (command == "expr") {
+        return test_expr();
+    } else if (command == "soa") {
+        return test_soa();
+    } else if (command == "array") {
+        return test_array();
+    } else if (command == "view") {
+        return test_view();
+    } else if (command == "dataset") {
+        return test_dataset();
+    } else if (command == "bitpacked") {
+        return test_bitpacked();
+    } else if (command == "codec") {
+        return test_codec();
+    } else if (command == "pipeline") {
+        return test_pipeline();
+    } else if (command == "parallel") {
+        return test_parallel();
+    } else if (command == "pool") {
+        return test_pool();
     } else {
         std::cerr << "Unknown command " << std::quoted(command) << std::endl;
         return -1;
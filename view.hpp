@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2023  Alister Sanders
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <fixp.hpp>
+
+namespace fixp {
+    namespace detail {
+        // fixed is a standard layout wrapper around a single Storage,
+        // which is what makes reading a Storage buffer as fixed values
+        // valid. Checked for every format that gets viewed
+        template<is_fixed T>
+        static constexpr bool has_storage_layout() {
+            using Storage = typename T::storage_type;
+
+            static_assert(std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T>,
+                          "fixed must be trivially copyable and standard layout");
+            static_assert(sizeof(T) == sizeof(Storage) && alignof(T) == alignof(Storage),
+                          "fixed must have the size and alignment of its storage");
+            static_assert(offsetof(T, raw) == 0, "raw must be the first member of fixed");
+
+            return true;
+        }
+
+        template<typename T, typename S>
+        requires is_fixed<std::remove_const_t<T>>
+        static T* view_as(S* data, std::size_t n) {
+            static_assert(has_storage_layout<std::remove_const_t<T>>());
+
+            #if defined(__cpp_lib_start_lifetime_as)
+            return std::start_lifetime_as_array<T>(data, n);
+            #else
+            // Compilers treat the member access through T as an access
+            // to S, which is the only thing this relies on
+            static_cast<void>(n);
+            return reinterpret_cast<T*>(data);
+            #endif
+        }
+    }
+
+    // A buffer of raw values, e.g. int16_t samples from a driver or a
+    // file, seen as values of T without copying. Writes through the
+    // span land in the buffer directly, and a const buffer gives a
+    // span of const T.
+    //
+    //   std::int16_t samples[256];
+    //   std::span<fixed_q0_15> x = fixp::span_view<fixed_q0_15>(samples);
+    template<is_fixed T, std::ranges::contiguous_range R>
+    requires std::ranges::borrowed_range<R>
+          && std::same_as<std::ranges::range_value_t<R>, typename T::storage_type>
+    static auto span_view(R&& raw) {
+        using S = std::remove_pointer_t<decltype(std::ranges::data(raw))>;
+        using V = std::conditional_t<std::is_const_v<S>, const T, T>;
+
+        const std::size_t n = std::ranges::size(raw);
+        return std::span<V> { detail::view_as<V>(std::ranges::data(raw), n), n };
+    }
+
+    template<is_fixed T, typename S>
+    requires std::same_as<std::remove_const_t<S>, typename T::storage_type>
+    static auto span_view(S* data, std::size_t n) {
+        return span_view<T>(std::span<S> { data, n });
+    }
+
+    // The opposite direction, the raw values behind an array of T,
+    // e.g. to hand results back to a driver
+    template<std::ranges::contiguous_range R>
+    requires std::ranges::borrowed_range<R> && is_fixed<std::ranges::range_value_t<R>>
+    static auto raw_view(R&& values) {
+        using T = std::remove_pointer_t<decltype(std::ranges::data(values))>;
+        static_assert(detail::has_storage_layout<std::remove_const_t<T>>());
+
+        return std::span { &std::ranges::data(values)->raw, std::ranges::size(values) };
+    }
+}